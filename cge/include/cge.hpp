@@ -11,11 +11,15 @@
 #include <cstddef>
 #include <cstdint>
 #include <cmath>
+#include <algorithm>
+#include <iterator>
 #include <numeric>
+#include <utility>
 #include <variant>
 #include <vector>
 #include <array>
 #include <span>
+#include <bit>
 
 namespace cge
 {
@@ -37,6 +41,32 @@ namespace cge
     struct dvec2 { double x, y; }; 
     struct dvec3 { double x, y, z; }; 
     struct dvec4 { double x, y, z, w; }; 
+
+    /// Column-major 4x4 matrix, laid out as GLSL expects it.
+    struct mat4 { vec4 x, y, z, w; };
+
+    static inline constexpr cge::mat4 identity{
+        .x = { 1.0f, 0.0f, 0.0f, 0.0f },
+        .y = { 0.0f, 1.0f, 0.0f, 0.0f },
+        .z = { 0.0f, 0.0f, 1.0f, 0.0f },
+        .w = { 0.0f, 0.0f, 0.0f, 1.0f },
+    };
+
+    /**
+     * @brief 2D transform: rotates counter-clockwise by `rotation` radians, scales by `scale`, then translates by `offset`.
+     * @details Scaling after rotating lets `scale` correct for the aspect ratio of clip space.
+     */
+    static inline cge::mat4 transform_2d(const cge::vec2 offset, const float rotation = 0.0f, const cge::vec2 scale = { 1.0f, 1.0f }) noexcept
+    {
+        const float c{ std::cos(rotation) };
+        const float s{ std::sin(rotation) };
+        return cge::mat4{
+            .x = {  c * scale.x, s * scale.y, 0.0f, 0.0f },
+            .y = { -s * scale.x, c * scale.y, 0.0f, 0.0f },
+            .z = { 0.0f, 0.0f, 1.0f, 0.0f },
+            .w = { offset.x, offset.y, 0.0f, 1.0f },
+        };
+    }
 }
 
 namespace cge
@@ -51,6 +81,122 @@ namespace cge
     using Index = cge::uint;
 
     using Color = cge::uint;
+
+    /**
+     * @brief Compact 16-byte vertex for 2D geometry.
+     * @details `u`/`v` are UNORM16 texture coordinates (`0xFFFF` is 1.0). The atlas is always sampled and modulated by `rgba`.
+     *          With no atlas uploaded, the atlas is a single white texel, so `rgba` is drawn as-is.
+     */
+    struct Vertex2D
+    {
+        vec2 xy;
+        std::uint16_t u, v;
+        Color rgba;
+    };
+    static_assert(sizeof(cge::Vertex2D) == 16);
+
+    /// Axis-aligned rectangle, drawn as a quad of `cge::Vertex2D`.
+    struct Rect
+    {
+        vec2 xy0; ///< First corner.
+        vec2 xy1; ///< Opposite corner.
+        std::uint16_t u0, v0; ///< Texture coordinates at `xy0`.
+        std::uint16_t u1, v1; ///< Texture coordinates at `xy1`.
+        Color rgba;
+    };
+
+    /**
+     * @brief A textured quad, drawn as one instance of a shared quad rather than as vertices and indices.
+     * @details `u0`/`v0`/`u1`/`v1` are UNORM16 texture coordinates, like those of `cge::Vertex2D`.
+     */
+    struct Sprite
+    {
+        vec2 xy; ///< Centre.
+        vec2 scale; ///< Width and height, before rotation.
+        float rotation; ///< Counter-clockwise, in radians.
+        std::uint16_t u0, v0; ///< Texture coordinates of the corner at `-scale / 2`.
+        std::uint16_t u1, v1; ///< Texture coordinates of the corner at `+scale / 2`.
+        Color rgba;
+    };
+    static_assert(sizeof(cge::Sprite) == 32);
+
+    /// Handle to geometry that stays resident on the GPU. See `cge::Scene::create_mesh`.
+    struct Mesh
+    {
+        cge::uint id; ///< One past the mesh's index in `cge::Scene::meshes`. Zero is never a valid mesh.
+    };
+
+    struct MeshData
+    {
+        std::vector<cge::Vertex> vertices;
+        std::vector<cge::Index> indices;
+        std::uint64_t revision; ///< Changes whenever the mesh is created or destroyed, so the renderer knows to re-upload it.
+        bool live;
+    };
+
+    struct MeshDraw
+    {
+        cge::Mesh mesh;
+        cge::Color tint; ///< Multiplies the colour of every vertex.
+        cge::mat4 transform; ///< Applied to every vertex position.
+    };
+
+    /// The kind of dynamic geometry a draw item covers. Each pass has its own pipeline and streams.
+    enum class Pass : std::uint8_t
+    {
+        opaque, ///< `cge::Scene::vertices`/`indices` drawn while `cge::Scene::opaque` is set: depth-tested and written, without blending.
+        triangles, ///< `cge::Scene::vertices`/`indices`.
+        triangles_2d, ///< `cge::Scene::vertices_2d`/`indices_2d`.
+        sprites, ///< `cge::Scene::sprites`.
+    };
+
+    static inline constexpr std::size_t num_passes{ 4 };
+
+    /**
+     * @brief Sort key of a draw item. From the most significant bits: layer (8), pass (8), texture (16), depth (32).
+     * @details Items sorted by key draw in layer order, and change pipeline and texture as rarely as possible within each layer.
+     */
+    using DrawKey = std::uint64_t;
+
+    /// Scissor rectangle in Scene resolution (`cge::Scene::res_w`/`res_h`), with the origin at the top-left.
+    struct ClipRect
+    {
+        cge::sint x, y;
+        cge::uint w, h;
+    };
+
+    /// A run of one pass's dynamic geometry: indices, or vertices if the pass has no indices, or sprite instances.
+    struct DrawItem
+    {
+        cge::DrawKey key;
+        cge::uint first;
+        cge::uint count;
+        cge::uint clip; ///< One past the index of the item's rectangle in `cge::Scene::clips`. Zero is unclipped.
+        cge::uint transform; ///< One past the index of the item's transform in `cge::Scene::transforms`. Zero is untransformed.
+    };
+
+    /// Applied by the GPU to every vertex of the dynamic geometry drawn while it is set. See `cge::Scene::set_transform`.
+    struct DrawTransform
+    {
+        cge::mat4 transform; ///< Applied to every vertex position, or to every sprite's centre and corners.
+        cge::Color tint; ///< Multiplies the colour of every vertex.
+    };
+
+    static inline constexpr cge::DrawKey draw_key(const std::uint8_t layer, const cge::Pass pass, const std::uint16_t texture, const float depth) noexcept
+    {
+        // Flips the float's bits so that they sort as unsigned integers in the same order as the floats.
+        const std::uint32_t bits{ std::bit_cast<std::uint32_t>(depth) };
+        const std::uint32_t order{ (bits & 0x8000'0000u) ? ~bits : (bits | 0x8000'0000u) };
+
+        return (cge::DrawKey(layer) << 56) | (cge::DrawKey(pass) << 48) | (cge::DrawKey(texture) << 32) | cge::DrawKey(order);
+    }
+
+    static inline constexpr cge::Pass draw_pass(const cge::DrawKey key) noexcept
+    { return static_cast<cge::Pass>((key >> 48) & 0xFF); }
+
+    /// The key without its depth. Items with the same state can be drawn together.
+    static inline constexpr cge::DrawKey draw_state(const cge::DrawKey key) noexcept
+    { return key >> 32; }
 }
 
 namespace cge
@@ -127,6 +273,224 @@ namespace cge
     extern cge::Viewport viewport(cge::uint window_w, cge::uint window_h, cge::uint render_w, cge::uint render_h, cge::Scaling scaling) noexcept;
 }
 
+namespace cge
+{
+    /**
+     * @brief Growable array of trivially-copyable elements, which can build into storage lent by the renderer.
+     * @details While borrowing, elements are written straight into GPU-visible memory. Reading them back is correct, but may be slow.
+     *          Growing past the lent capacity moves the elements into owned storage, after which the renderer copies them as usual.
+     *          Has the parts of the `std::vector` interface that are used to build geometry.
+     */
+    template <typename T>
+    class Buffer
+    {
+    public:
+
+        using value_type = T;
+
+    private:
+
+        std::vector<T> owned;
+        T* lent_ptr{};
+        std::size_t lent_len{};
+        std::size_t lent_cap{};
+        std::uint32_t grown{};
+        bool touched{};
+
+        inline constexpr void track(const std::size_t old_capacity) noexcept
+        {
+            if (owned.capacity() != old_capacity) ++grown;
+        }
+
+    public:
+
+        inline constexpr bool borrowing() const noexcept { return lent_ptr != nullptr; }
+
+        /// Non-const access counts as a write. See `take_touched`.
+        inline constexpr T* data() noexcept { touched = true; return borrowing() ? lent_ptr : owned.data(); }
+        inline constexpr const T* data() const noexcept { return borrowing() ? lent_ptr : owned.data(); }
+        inline constexpr std::size_t size() const noexcept { return borrowing() ? lent_len : owned.size(); }
+        inline constexpr std::size_t capacity() const noexcept { return borrowing() ? lent_cap : owned.capacity(); }
+        inline constexpr bool empty() const noexcept { return size() == 0; }
+
+        inline constexpr T* begin() noexcept { return data(); }
+        inline constexpr T* end() noexcept { return data() + size(); }
+        inline constexpr const T* begin() const noexcept { return data(); }
+        inline constexpr const T* end() const noexcept { return data() + size(); }
+
+        inline constexpr T& operator[](const std::size_t idx) noexcept { return data()[idx]; }
+        inline constexpr const T& operator[](const std::size_t idx) const noexcept { return data()[idx]; }
+
+        inline constexpr T& front() noexcept { return data()[0]; }
+        inline constexpr T& back() noexcept { return data()[size() - 1]; }
+        inline constexpr const T& front() const noexcept { return data()[0]; }
+        inline constexpr const T& back() const noexcept { return data()[size() - 1]; }
+
+        inline constexpr void clear() noexcept
+        {
+            touched = true;
+            lent_len = 0;
+            owned.clear();
+        }
+
+        inline constexpr void reserve(const std::size_t count)
+        {
+            if (count <= capacity()) return;
+            unborrow(count);
+        }
+
+        inline constexpr void push_back(const T& elem)
+        {
+            touched = true;
+            if (borrowing())
+            {
+                if (lent_len < lent_cap)
+                {
+                    lent_ptr[lent_len++] = elem;
+                    return;
+                }
+                unborrow(lent_cap * 2);
+            }
+            const std::size_t old_capacity{ owned.capacity() };
+            owned.push_back(elem);
+            track(old_capacity);
+        }
+
+        template <typename... Args>
+        inline constexpr T& emplace_back(Args&&... args)
+        {
+            push_back(T(std::forward<Args>(args)...));
+            return back();
+        }
+
+        inline constexpr void pop_back() noexcept { truncate(size() - 1); }
+
+        /**
+         * @brief Appends `count` elements, and returns a pointer to the first of them.
+         * @details The new elements are uninitialized while borrowing, and value-initialized otherwise. Either way, the caller is expected to overwrite them.
+         */
+        inline constexpr T* extend(const std::size_t count)
+        {
+            touched = true;
+            const std::size_t old_size{ size() };
+            if (borrowing())
+            {
+                if (count <= lent_cap - lent_len)
+                {
+                    lent_len += count;
+                    return lent_ptr + old_size;
+                }
+                unborrow(std::max(lent_cap * 2, old_size + count));
+            }
+            const std::size_t old_capacity{ owned.capacity() };
+            owned.resize(old_size + count);
+            track(old_capacity);
+            return owned.data() + old_size;
+        }
+
+        /// Drops the elements past the first `count`, keeping the storage.
+        inline constexpr void truncate(const std::size_t count) noexcept
+        {
+            if (count >= size()) return;
+
+            touched = true;
+            if (borrowing())
+                lent_len = count;
+            else
+                owned.resize(count);
+        }
+
+        inline constexpr void resize(const std::size_t count, const T& elem = T{})
+        {
+            const std::size_t old_size{ size() };
+            if (count <= old_size) return truncate(count);
+
+            T* const dst{ extend(count - old_size) };
+            std::fill(dst, dst + (count - old_size), elem);
+        }
+
+        /// Inserts `[first, last)` before `pos`, and returns a pointer to the first element inserted.
+        template <std::forward_iterator It>
+        inline constexpr T* insert(const T* const pos, const It first, const It last)
+        {
+            const std::size_t offs{ static_cast<std::size_t>(pos - data()) };
+            const std::size_t count{ static_cast<std::size_t>(std::distance(first, last)) };
+            const std::size_t old_size{ size() };
+            if (count == 0) return data() + offs;
+
+            // Extending may move the storage, so `pos` is only used as an offset.
+            T* const base{ extend(count) - old_size };
+            std::move_backward(base + offs, base + old_size, base + old_size + count);
+            std::copy(first, last, base + offs);
+            return base + offs;
+        }
+
+        inline constexpr T* insert(const T* const pos, const T& elem)
+        {
+            const T copy{ elem };
+            return insert(pos, &copy, &copy + 1);
+        }
+
+        inline constexpr void append(const std::span<const T> elems)
+        {
+            if (elems.empty()) return;
+            T* const dst{ extend(elems.size()) };
+            std::copy(elems.begin(), elems.end(), dst);
+        }
+
+        /// Starts building into `count` elements at `ptr`. The previous contents are discarded.
+        inline constexpr void borrow(T* const ptr, const std::size_t count) noexcept
+        {
+            touched = true;
+            owned.clear();
+            lent_ptr = ptr;
+            lent_len = 0;
+            lent_cap = count;
+        }
+
+        /// Moves the elements into owned storage, so the lent memory may be reused.
+        inline constexpr void unborrow(const std::size_t min_capacity = 0)
+        {
+            const std::size_t old_capacity{ owned.capacity() };
+            if (!borrowing())
+            {
+                owned.reserve(min_capacity);
+                track(old_capacity);
+                return;
+            }
+
+            owned.reserve(min_capacity > lent_len ? min_capacity : lent_len);
+            owned.assign(lent_ptr, lent_ptr + lent_len);
+            track(old_capacity);
+            lent_ptr = nullptr;
+            lent_len = 0;
+            lent_cap = 0;
+        }
+
+        /// Releases owned storage beyond `count` elements (or the current size, if larger). Lent storage is unaffected. Returns true if anything was released.
+        inline constexpr bool shrink(const std::size_t count)
+        {
+            const std::size_t target{ std::max(count, owned.size()) };
+            if (owned.capacity() <= target) return false;
+
+            std::vector<T> smaller{};
+            smaller.reserve(target);
+            smaller.assign(owned.begin(), owned.end());
+            owned.swap(smaller);
+            return true;
+        }
+
+        /// Bytes held by owned storage.
+        inline constexpr std::size_t owned_bytes() const noexcept { return owned.capacity() * sizeof(T); }
+
+        /// Returns true if the elements may have been written since the last call.
+        inline constexpr bool take_touched() noexcept { return std::exchange(touched, false); }
+
+        /// Returns how many times owned storage was (re)allocated since the last call.
+        inline constexpr std::uint32_t take_growths() noexcept { return std::exchange(grown, 0); }
+    };
+}
+
 namespace cge
 {
     struct Settings
@@ -137,19 +501,102 @@ namespace cge
         double fps;
         bool vsync;
         bool fullscreen;
+        bool zero_copy; ///< Build the Scene's dynamic geometry straight into mapped GPU memory. It then starts empty every frame.
+        bool triple_buffer; ///< Hand each frame's Scene to the render thread through a mailbox, so the next frame is built while the last is rendered. The Scene then starts empty every frame. Read once at startup. Takes precedence over `zero_copy`.
+        bool worker_callbacks; ///< Call `cge::Game::event`, `update` and `render` on a dedicated game thread, leaving the main thread to handle the window. Read once at startup.
+        bool fixed_timestep; ///< Call `cge::Game::update` exactly `fps` times per second of simulation, running late updates back to back to catch up instead of skipping them. Read once at startup.
+        std::uint32_t max_catch_up{ 8 }; ///< With `fixed_timestep`, how many updates the simulation may fall behind. Beyond that it runs slower than real time, still without skipping updates.
+        bool skip_unchanged; ///< Skip rendering a frame whose Scene is the same as the last frame rendered, leaving that frame on screen. Has no effect with `zero_copy`.
+    };
+
+    /// Element counts of a Scene's dynamic geometry.
+    struct SceneCounts
+    {
+        std::size_t vertices;
+        std::size_t indices;
+        std::size_t vertices_2d;
+        std::size_t indices_2d;
+        std::size_t sprites;
+    };
+
+    struct SceneStats
+    {
+        std::uint64_t frames; ///< Frames built so far.
+        std::uint64_t skipped; ///< Frames among `frames` that were not rendered, as they were unchanged. See `cge::Settings::skip_unchanged`.
+        cge::SceneCounts used; ///< Geometry drawn in the last frame.
+        cge::SceneCounts peak; ///< High-water mark that owned storage is currently kept at.
+        std::size_t used_bytes; ///< Bytes of geometry drawn in the last frame.
+        std::size_t owned_bytes; ///< Bytes of storage owned by the Scene after the last frame.
+        std::uint32_t growths; ///< Allocations made while building the last frame. Zero once the Scene has reached a steady state.
+        std::uint32_t shrinks; ///< Times owned storage was released so far.
+        std::size_t culled; ///< Triangles and sprites rejected by `cge::Scene::cull` in the last frame.
     };
 
     struct Scene
     {
     public:
 
-        cge::uint res_w;
-        cge::uint res_h;
-        cge::Scaling scaling;
-
-        cge::Color backcolor;
-        std::vector<cge::Vertex> vertices;
-        std::vector<cge::Index> indices;
+        cge::uint res_w{};
+        cge::uint res_h{};
+        cge::Scaling scaling{};
+
+        cge::Color backcolor{};
+        cge::Buffer<cge::Vertex> vertices;
+        cge::Buffer<cge::Index> indices;
+
+        cge::Buffer<cge::Vertex2D> vertices_2d;
+        cge::Buffer<cge::Index> indices_2d;
+
+        cge::Buffer<cge::Sprite> sprites;
+
+        std::vector<cge::Vertex> static_vertices;
+        std::vector<cge::Index> static_indices;
+        std::uint64_t static_revision{};
+
+        std::vector<cge::MeshData> meshes; ///< Indexed by `cge::Mesh::id - 1`.
+        std::vector<cge::uint> free_meshes; ///< Indices of destroyed meshes, reused by `create_mesh`.
+        std::uint64_t mesh_revision{}; ///< Latest revision of any mesh. Unchanged means no mesh needs uploading.
+        std::vector<cge::MeshDraw> mesh_draws; ///< Cleared by `clear`, like the rest of the frame's geometry.
+
+        std::uint8_t layer{}; ///< Layer of subsequent draws. Lower layers are drawn first. Reset by `clear`.
+        float depth{}; ///< Order of subsequent draws within their layer and pass. Lower depths are drawn first. Reset by `clear`.
+        bool opaque{}; ///< Subsequent 3D triangles are opaque. They are drawn before everything else regardless of `layer`, front-to-back by `depth`, and hide what is behind them by Z. Reset by `clear`.
+        std::vector<cge::DrawItem> items; ///< The frame's dynamic geometry, in draw order once `sort_items` has run.
+        std::vector<cge::ClipRect> clips; ///< Every rectangle pushed since `clear`, already intersected with the ones it was pushed inside of.
+        std::vector<cge::DrawTransform> transforms; ///< Every transform set since `clear`.
+
+        std::uint32_t retain_frames{ 240 }; ///< Owned storage is kept at the peak usage over roughly this many frames, then shrinks. Zero never shrinks.
+        cge::SceneStats stats{}; ///< Updated by `end_frame`.
+
+        /**
+         * @brief Rejects triangles and sprites that lie entirely outside clip space before they are uploaded. See `cull`.
+         * @details Culled geometry is removed from the Scene, so this is only for Scenes that are cleared every frame.
+         */
+        bool culling{};
+
+    private:
+
+        cge::SceneCounts window_peak{}; ///< Peak usage in the current retention window.
+        cge::SceneCounts prev_peak{}; ///< Peak usage in the previous retention window.
+        std::uint32_t window_frames{};
+
+        std::array<cge::uint, cge::num_passes> marked{}; ///< Elements of each pass already covered by `items`.
+        std::vector<cge::uint> clip_stack; ///< The clips to return to on `pop_clip`.
+        cge::uint clip_top{}; ///< Clip of subsequent draws, like `cge::DrawItem::clip`.
+        cge::uint transform_top{}; ///< Transform of subsequent draws, like `cge::DrawItem::transform`.
+        std::vector<cge::DrawItem> item_scratch;
+        std::vector<std::size_t> merge_bases; ///< Where each fragment lands in the merged streams. See `merge_layout`.
+        cge::Vertex* merge_vertices{}; ///< Where `merge_fragment` copies to, as laid out by `merge_layout`.
+        cge::Index* merge_indices{}; ///< Null if the merged stream is unindexed.
+        cge::Vertex2D* merge_vertices_2d{};
+        cge::Index* merge_indices_2d{}; ///< Null if the merged stream is unindexed.
+        cge::Sprite* merge_sprites{};
+        std::uint64_t revision{}; ///< Bumped by every function that changes what the Scene draws. See `touch`.
+        std::uint64_t hashed_revision{}; ///< `revision` when `hashed_body` was computed.
+        std::uint64_t hashed_body{}; ///< Hash of the geometry, draws, items, clips and transforms. Zero if not computed.
+
+        /// Covers any geometry not yet covered by `items`.
+        void mark_all();
 
     public:
 
@@ -157,61 +604,330 @@ namespace cge
         {
             vertices.clear();
             indices.clear();
+            vertices_2d.clear();
+            indices_2d.clear();
+            sprites.clear();
+            mesh_draws.clear();
+            items.clear();
+            clips.clear();
+            clip_stack.clear();
+            clip_top = 0;
+            transforms.clear();
+            transform_top = 0;
+            marked = {};
+            layer = 0;
+            depth = 0.0f;
+            opaque = false;
+            ++revision;
+        }
+
+        /// Records a change the Scene cannot see: a write straight into `items`, `clips`, `transforms` or `mesh_draws`. Writes into the geometry buffers are seen.
+        inline constexpr void touch() noexcept { ++revision; }
+
+        /// Pre-sizes the dynamic geometry, so that building a frame of up to `counts` elements does not allocate.
+        inline constexpr void reserve(const cge::SceneCounts& counts)
+        {
+            vertices.reserve(counts.vertices);
+            indices.reserve(counts.indices);
+            vertices_2d.reserve(counts.vertices_2d);
+            indices_2d.reserve(counts.indices_2d);
+            sprites.reserve(counts.sprites);
+        }
+
+        /**
+         * @brief Records the frame's usage in `stats`, and releases storage that has gone unused for `retain_frames` frames.
+         * @details Called by the engine after each frame is rendered.
+         */
+        void end_frame();
+
+        /**
+         * @brief Sorts `items` by key, and merges adjacent items that share a state, a clip, a transform and a contiguous range.
+         * @details Geometry added without a draw call (straight into the buffers) gets an item of its own. Called by the engine before each frame is rendered.
+         */
+        void sort_items();
+
+        /**
+         * @brief Hashes everything that decides what the Scene draws, so that a frame identical to the last can be recognised.
+         * @details Meaningful once `sort_items` has run. Returns zero if any geometry is built into lent memory, which is slow to read back.
+         *          If nothing was drawn, cleared or written since the last call, the last hash is reused without reading the geometry again.
+         */
+        std::uint64_t hash() noexcept;
+
+        /**
+         * @brief Removes the triangles and sprites outside clip space, and compacts the index streams and `items` to match.
+         * @details Vertices are left in place. Streams built into lent memory are not culled, as reading them back may be slow, and neither are transformed items.
+         *          Called by the engine before `sort_items` if `culling` is set.
+         */
+        void cull();
+
+        /// Moves any geometry built into renderer-owned memory into the Scene's own storage.
+        inline constexpr void unborrow()
+        {
+            vertices.unborrow();
+            indices.unborrow();
+            vertices_2d.unborrow();
+            indices_2d.unborrow();
+            sprites.unborrow();
+        }
+
+        /**
+         * @brief Replaces the static geometry.
+         * @details Static geometry is uploaded once into GPU memory and drawn every frame after the opaque triangles and before the rest of `vertices`/`indices`, until it is replaced again.
+         */
+        inline constexpr void set_static(const std::span<const cge::Vertex> vtx_list, const std::span<const cge::Index> idx_list)
+        {
+            static_vertices.assign(vtx_list.begin(), vtx_list.end());
+            static_indices.assign(idx_list.begin(), idx_list.end());
+            ++static_revision;
+        }
+
+        /**
+         * @brief Creates a mesh, which is uploaded into GPU memory once and can then be drawn any number of times.
+         * @details The mesh is uploaded before the next frame it is drawn in, and stays resident until `destroy_mesh`.
+         */
+        inline constexpr cge::Mesh create_mesh(const std::span<const cge::Vertex> vtx_list, const std::span<const cge::Index> idx_list)
+        {
+            cge::uint mesh_idx{};
+            if (free_meshes.empty())
+            {
+                mesh_idx = static_cast<cge::uint>(meshes.size());
+                meshes.emplace_back();
+            }
+            else
+            {
+                mesh_idx = free_meshes.back();
+                free_meshes.pop_back();
+            }
+
+            cge::MeshData& mesh{ meshes[mesh_idx] };
+            mesh.vertices.assign(vtx_list.begin(), vtx_list.end());
+            mesh.indices.assign(idx_list.begin(), idx_list.end());
+            mesh.revision = ++mesh_revision;
+            mesh.live = true;
+
+            return cge::Mesh{ .id = mesh_idx + 1 };
+        }
+
+        inline constexpr void destroy_mesh(const cge::Mesh handle)
+        {
+            if ((handle.id == 0) || (handle.id > meshes.size())) return;
+
+            cge::MeshData& mesh{ meshes[handle.id - 1] };
+            if (!mesh.live) return;
+
+            mesh.vertices = {};
+            mesh.indices = {};
+            mesh.revision = ++mesh_revision;
+            mesh.live = false;
+            free_meshes.push_back(handle.id - 1);
+        }
+
+        /**
+         * @brief Clips subsequent dynamic geometry to `rect`, intersected with the current clip, until the matching `pop_clip`.
+         * @details Each clip becomes a scissor rectangle, so clipped geometry costs no CPU work and no wasted pixels.
+         */
+        inline constexpr void push_clip(const cge::ClipRect& rect)
+        {
+            cge::ClipRect clipped{ rect };
+            if (clip_top != 0)
+            {
+                const cge::ClipRect& outer{ clips[clip_top - 1] };
+                const std::int64_t x0{ std::max<std::int64_t>(rect.x, outer.x) };
+                const std::int64_t y0{ std::max<std::int64_t>(rect.y, outer.y) };
+                const std::int64_t x1{ std::min<std::int64_t>(std::int64_t(rect.x) + rect.w, std::int64_t(outer.x) + outer.w) };
+                const std::int64_t y1{ std::min<std::int64_t>(std::int64_t(rect.y) + rect.h, std::int64_t(outer.y) + outer.h) };
+                clipped = cge::ClipRect{
+                    .x = static_cast<cge::sint>(x0),
+                    .y = static_cast<cge::sint>(y0),
+                    .w = static_cast<cge::uint>(std::max<std::int64_t>(x1 - x0, 0)),
+                    .h = static_cast<cge::uint>(std::max<std::int64_t>(y1 - y0, 0)),
+                };
+            }
+
+            clips.push_back(clipped);
+            clip_stack.push_back(clip_top);
+            clip_top = static_cast<cge::uint>(clips.size());
+            ++revision;
+        }
+
+        inline constexpr void pop_clip()
+        {
+            if (clip_stack.empty()) return;
+
+            clip_top = clip_stack.back();
+            clip_stack.pop_back();
+        }
+
+        /**
+         * @brief Transforms and tints subsequent dynamic geometry on the GPU, until the next `set_transform` or `reset_transform`.
+         * @details Geometry built once can then be moved every frame by changing only the transform. Transformed geometry is never culled, as its position is not known until it is drawn.
+         */
+        inline constexpr void set_transform(const cge::mat4& transform, const cge::Color tint = 0xFFFFFFFF)
+        {
+            transforms.push_back(cge::DrawTransform{ .transform = transform, .tint = tint });
+            transform_top = static_cast<cge::uint>(transforms.size());
+            ++revision;
+        }
+
+        inline constexpr void reset_transform() noexcept
+        {
+            transform_top = 0;
+        }
+
+        /// Draws a mesh this frame, after opaque triangles and the static geometry, and before the rest of the frame's geometry.
+        inline constexpr void draw_mesh(const cge::Mesh handle, const cge::mat4& transform = cge::identity, const cge::Color tint = 0xFFFFFFFF)
+        {
+            mesh_draws.push_back(cge::MeshDraw{ .mesh = handle, .tint = tint, .transform = transform });
+            ++revision;
         }
 
         inline constexpr void draw_tri(const std::span<const cge::Vertex, 3> vtx_list)
+        { Scene::emit_tri(vertices, indices, vtx_list); mark(cge::Pass::triangles, indices.size()); }
+
+        inline constexpr void draw_strip(const std::span<const cge::Vertex /* 3+ */> vtx_list)
+        { Scene::emit_strip(vertices, indices, vtx_list); mark(cge::Pass::triangles, indices.size()); }
+
+        inline constexpr void draw_fan(const std::span<const cge::Vertex /* 3+ */> vtx_list)
+        { Scene::emit_fan(vertices, indices, vtx_list); mark(cge::Pass::triangles, indices.size()); }
+
+        inline constexpr void draw_tri(const std::span<const cge::Vertex2D, 3> vtx_list)
+        { Scene::emit_tri(vertices_2d, indices_2d, vtx_list); mark(cge::Pass::triangles_2d, indices_2d.size()); }
+
+        inline constexpr void draw_strip(const std::span<const cge::Vertex2D /* 3+ */> vtx_list)
+        { Scene::emit_strip(vertices_2d, indices_2d, vtx_list); mark(cge::Pass::triangles_2d, indices_2d.size()); }
+
+        inline constexpr void draw_fan(const std::span<const cge::Vertex2D /* 3+ */> vtx_list)
+        { Scene::emit_fan(vertices_2d, indices_2d, vtx_list); mark(cge::Pass::triangles_2d, indices_2d.size()); }
+
+        /// Draws `vtx_list.size() / 3` separate triangles. Leftover vertices are ignored.
+        void draw_tris(std::span<const cge::Vertex> vtx_list);
+        void draw_tris(std::span<const cge::Vertex2D> vtx_list);
+
+        /// Draws `vtx_list.size() / 4` quads, each split the same way as `draw_fan` would. Leftover vertices are ignored.
+        void draw_quads(std::span<const cge::Vertex> vtx_list);
+        void draw_quads(std::span<const cge::Vertex2D> vtx_list);
+
+        /// Draws a sprite. Within a layer, sprites are drawn after the other geometry, in as few instanced draws as possible.
+        inline constexpr void draw_sprite(const cge::Sprite& sprite)
+        { sprites.push_back(sprite); mark(cge::Pass::sprites, sprites.size()); }
+
+        inline constexpr void draw_sprites(const std::span<const cge::Sprite> sprite_list)
+        { sprites.append(sprite_list); mark(cge::Pass::sprites, sprites.size()); }
+
+        /**
+         * @brief Appends the dynamic geometry, draw items, clips, transforms and mesh draws of each fragment, in order.
+         * @details Fragments are ordinary Scenes, so each can be built on its own thread while the others are built.
+         *          The result is the same as drawing every fragment into this Scene in turn, except that they keep their own clips and transforms rather than inheriting this Scene's.
+         *          Mesh draws are appended as they are, so a fragment may only draw meshes created on this Scene. Handles from a fragment's own `create_mesh` are not valid here.
+         *          The fragments are only read, apart from covering any geometry added straight into their buffers with items.
+         *          The engine does not merge fragments itself: the game joins its threads and calls this from `cge::Game::render`, on the Scene it was given.
+         *          Equivalent to `merge_layout` followed by `merge_fragment` for each fragment in turn.
+         */
+        void merge(std::span<cge::Scene* const> fragments);
+
+        /**
+         * @brief The serial half of `merge`: places each fragment, grows the buffers once, and appends the items, clips, transforms and mesh draws.
+         * @details The geometry itself is left for `merge_fragment`. Until every fragment has been copied, neither this Scene nor the fragments may be changed.
+         */
+        void merge_layout(std::span<cge::Scene* const> fragments);
+
+        /**
+         * @brief Copies the geometry of `fragments[idx]` into the range `merge_layout` gave it.
+         * @details Fragments are copied into disjoint ranges, so different fragments may be copied at once, from different threads.
+         */
+        void merge_fragment(std::span<cge::Scene* const> fragments, std::size_t idx) const noexcept;
+
+        /**
+         * @brief Swaps this frame's contents into `frame`, which the render thread then owns, and takes `frame`'s storage back empty.
+         * @details Settings and resolution are copied. Static geometry and meshes are copied only when their revision differs from `frame`'s.
+         */
+        void hand_off(cge::Scene& frame);
+
+        /// Draws each rectangle as a quad of `cge::Vertex2D`.
+        void draw_rects(std::span<const cge::Rect> rect_list);
+
+        /// Draws indexed triangles. `idx_list` indexes into `vtx_list`, and is rebased onto the Scene's vertices.
+        void draw_indexed(std::span<const cge::Vertex> vtx_list, std::span<const cge::Index> idx_list);
+        void draw_indexed(std::span<const cge::Vertex2D> vtx_list, std::span<const cge::Index> idx_list);
+
+    private:
+
+        /// Covers the elements of `pass` drawn since the last mark with an item, extending the last item if it has the same key.
+        inline constexpr void mark(const cge::Pass pass, const std::size_t end)
+        {
+            cge::uint& first{ marked[std::size_t(pass)] };
+            if (end <= first) return;
+
+            // Opaque triangles share the stream of the other 3D triangles, so they are marked against it.
+            const bool is_opaque{ opaque && (pass == cge::Pass::triangles) };
+            const cge::DrawKey key{ is_opaque ? cge::draw_key(0, cge::Pass::opaque, 0, depth) : cge::draw_key(layer, pass, 0, depth) };
+            const cge::uint count{ static_cast<cge::uint>(end - first) };
+
+            const bool same_state{ !items.empty() && (items.back().key == key) && (items.back().clip == clip_top) && (items.back().transform == transform_top) };
+            if (same_state && (items.back().first + items.back().count == first))
+                items.back().count += count;
+            else
+                items.push_back(cge::DrawItem{ .key = key, .first = first, .count = count, .clip = clip_top, .transform = transform_top });
+
+            first = static_cast<cge::uint>(end);
+            ++revision;
+        }
+
+        template <typename V>
+        static inline constexpr void emit_tri(cge::Buffer<V>& vtx_out, cge::Buffer<cge::Index>& idx_out, const std::span<const V, 3> vtx_list)
         {
-            const cge::Index base{ static_cast<cge::Index>(vertices.size()) };
+            const cge::Index base{ static_cast<cge::Index>(vtx_out.size()) };
             
-            vertices.push_back(vtx_list[0]);
-            vertices.push_back(vtx_list[1]);
-            vertices.push_back(vtx_list[2]);
+            vtx_out.append(vtx_list);
 
-            indices.push_back(base);
-            indices.push_back(base + 1);
-            indices.push_back(base + 2);
+            cge::Index* const idx{ idx_out.extend(3) };
+            idx[0] = base;
+            idx[1] = base + 1;
+            idx[2] = base + 2;
         }
 
-        inline constexpr void draw_strip(const std::span<const cge::Vertex /* 3+ */> vtx_list)
+        template <typename V>
+        static inline constexpr void emit_strip(cge::Buffer<V>& vtx_out, cge::Buffer<cge::Index>& idx_out, const std::span<const V /* 3+ */> vtx_list)
         {
             if (vtx_list.size() < 3) return;
 
-            const cge::Index base{ static_cast<cge::Index>(vertices.size()) };
+            const cge::Index base{ static_cast<cge::Index>(vtx_out.size()) };
             
-            vertices.push_back(vtx_list[0]);
-            vertices.push_back(vtx_list[1]);
-            for (cge::Index rel{ 2 }; rel < vtx_list.size(); ++rel)
+            vtx_out.append(vtx_list);
+
+            cge::Index* idx{ idx_out.extend((vtx_list.size() - 2) * 3) };
+            for (cge::Index rel{ 2 }; rel < vtx_list.size(); ++rel, idx += 3)
             {
-                vertices.push_back(vtx_list[rel]);
                 if (rel % 2 == 0)
                 {
-                    indices.push_back(base + rel - 2);
-                    indices.push_back(base + rel - 1);
-                    indices.push_back(base + rel);
+                    idx[0] = base + rel - 2;
+                    idx[1] = base + rel - 1;
+                    idx[2] = base + rel;
                 }
                 else
                 {
-                    indices.push_back(base + rel - 2);
-                    indices.push_back(base + rel);
-                    indices.push_back(base + rel - 1);
+                    idx[0] = base + rel - 2;
+                    idx[1] = base + rel;
+                    idx[2] = base + rel - 1;
                 }
             }
         }
 
-        inline constexpr void draw_fan(const std::span<const cge::Vertex /* 3+ */> vtx_list)
+        template <typename V>
+        static inline constexpr void emit_fan(cge::Buffer<V>& vtx_out, cge::Buffer<cge::Index>& idx_out, const std::span<const V /* 3+ */> vtx_list)
         {
             if (vtx_list.size() < 3) return;
 
-            const cge::Index base{ static_cast<cge::Index>(vertices.size()) };
+            const cge::Index base{ static_cast<cge::Index>(vtx_out.size()) };
+
+            vtx_out.append(vtx_list);
 
-            vertices.push_back(vtx_list[0]);
-            vertices.push_back(vtx_list[1]);
-            for (cge::Index rel{ 2 }; rel < vtx_list.size(); ++rel)
+            cge::Index* idx{ idx_out.extend((vtx_list.size() - 2) * 3) };
+            for (cge::Index rel{ 2 }; rel < vtx_list.size(); ++rel, idx += 3)
             {
-                vertices.push_back(vtx_list[rel]);
-                indices.push_back(base + rel - 1);
-                indices.push_back(base + rel);
-                indices.push_back(base);
+                idx[0] = base + rel - 1;
+                idx[1] = base + rel;
+                idx[2] = base;
             }
         }
     };
@@ -253,6 +969,9 @@ namespace cge
     extern cge::Settings& settings(cge::Engine& engine) noexcept;
 
     extern double elapsed_seconds(const cge::Engine& engine) noexcept;
+
+    /// How far the current time is between the last update and the next one, from 0 to 1. Meant for `cge::Game::render`, to interpolate between the last two states simulated.
+    extern double tick_alpha(const cge::Engine& engine) noexcept;
 }
 
 namespace cge
@@ -8,9 +8,11 @@
 #include <filesystem>
 #include <algorithm>
 #include <string>
+#include <bit>
 
 #include "cvk.hpp"
 #include "../soa.hpp"
+#include "../simd.hpp"
 
 namespace cvk
 {
@@ -49,12 +51,26 @@ namespace cvk
     static void update_surface_info(cvk::Context& ctx, cvk::Renderable& gfx, cvk::Offset device_idx, bool vsync) noexcept;
     static void reinit_device(cvk::Context& ctx, cvk::Renderable& gfx) noexcept;
     static void deinit_device(cvk::Context& ctx, cvk::Renderable& gfx) noexcept;
+    static void select_upload_memory(cvk::Context& ctx, cvk::Renderable& gfx) noexcept;
     static void reinit_buffers(cvk::Context& ctx, cvk::Renderable& gfx) noexcept;
     static void deinit_buffers(cvk::Context& ctx, cvk::Renderable& gfx) noexcept;
+    static VkResult create_buffer(cvk::Context& ctx, cvk::Renderable& gfx, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags props, std::span<const cvk::Offset> families, cvk::Strategy strategy, VkBuffer& buffer, cvk::Allocation& memory, VkMemoryRequirements& memreqs, void*& mapped) noexcept;
+    static void destroy_buffer(cvk::Context& ctx, cvk::Renderable& gfx, VkBuffer& buffer, cvk::Allocation& memory, void*& mapped) noexcept;
+    static VkResult grow_buffers(cvk::Context& ctx, cvk::Renderable& gfx, cvk::Offset frame_idx, VkDeviceSize required) noexcept;
+    static void release_buffers(cvk::Context& ctx, cvk::Renderable& gfx, cvk::Offset frame_idx) noexcept;
+    static VkResult wait_frames(cvk::Renderable& gfx, std::uint64_t frames) noexcept;
+    static void deinit_static(cvk::Context& ctx, cvk::Renderable& gfx) noexcept;
+    static VkResult upload_static(cvk::Context& ctx, cvk::Renderable& gfx, cvk::Offset frame_idx, const cge::Scene& scene) noexcept;
+    static VkResult upload_resident(cvk::Context& ctx, cvk::Renderable& gfx, std::span<const cge::Vertex> vtx_list, std::span<const cge::Index> idx_list, VkBuffer& buffer, cvk::Allocation& memory, VkDeviceSize& idx_offs, VkIndexType& idx_type) noexcept;
+    static void deinit_meshes(cvk::Context& ctx, cvk::Renderable& gfx) noexcept;
+    static VkResult upload_meshes(cvk::Context& ctx, cvk::Renderable& gfx, cvk::Offset frame_idx, const cge::Scene& scene) noexcept;
+    static VkResult upload_geometry(cvk::Context& ctx, cvk::Renderable& gfx, cvk::Offset frame_idx, std::span<const cvk::Stream> streams, std::span<VkBuffer> buffers, std::span<VkDeviceSize> offsets) noexcept;
     static void reinit_cmdpool(cvk::Context& ctx, cvk::Renderable& gfx) noexcept;
     static void deinit_cmdpool(cvk::Context& ctx, cvk::Renderable& gfx) noexcept;
     extern void remake_swapchain(cvk::Context& ctx, cvk::Renderable& gfx, bool vsync) noexcept;
     static void deinit_swapchain(cvk::Context& ctx, cvk::Renderable& gfx, bool deallocate) noexcept;
+    static void reinit_depth(cvk::Context& ctx, cvk::Renderable& gfx) noexcept;
+    static void deinit_depth(cvk::Context& ctx, cvk::Renderable& gfx) noexcept;
     static void reinit_shaders(cvk::Context& ctx, cvk::Renderable& gfx) noexcept;
     static void deinit_shaders(cvk::Context& ctx, cvk::Renderable& gfx) noexcept;
     static void reinit_renderpass(cvk::Context& ctx, cvk::Renderable& gfx) noexcept;
@@ -72,12 +88,13 @@ namespace cvk
     static void transition_atlas(cvk::Context& ctx, cvk::Renderable& gfx, cvk::Offset atlas_idx, VkImageLayout old_layout, VkImageLayout new_layout) noexcept;
     static void stage_texture(cvk::Context& ctx, cvk::Renderable& gfx, cvk::Offset atlas_idx, cge::Texture tex) noexcept;
     static void update_descriptors(cvk::Context& ctx, cvk::Renderable& gfx, cvk::Offset atlas_idx) noexcept;
-    static void single_commands(cvk::Context& ctx, cvk::Renderable& gfx, auto&& callback) noexcept;
+    static VkResult single_commands(cvk::Context& ctx, cvk::Renderable& gfx, VkCommandPool command_pool, VkQueue queue, auto&& callback) noexcept;
 
     static void select_device(cvk::Context& ctx, cvk::Renderable& gfx) noexcept;
     static cvk::Ranking rank_device(const cvk::Context& ctx, const cvk::Renderable& gfx, cvk::Offset device_idx) noexcept;
     static cvk::Ranking rank_device_graphics(const cvk::Context& ctx, const cvk::Renderable& gfx, cvk::Offset device_idx, cvk::Offset queue_idx) noexcept;
     static cvk::Ranking rank_device_present(const cvk::Context& ctx, const cvk::Renderable& gfx, cvk::Offset device_idx, cvk::Offset queue_idx) noexcept;
+    static cvk::Ranking rank_device_transfer(const cvk::Context& ctx, const cvk::Renderable& gfx, cvk::Offset device_idx, cvk::Offset queue_idx) noexcept;
 
     static bool str_equal(const char* a, const char* b) noexcept;
     static bool has_extensions(std::span<const VkExtensionProperties> sup_exts, std::span<const char* const> req_exts) noexcept;
@@ -85,14 +102,19 @@ namespace cvk
     static std::vector<char> load_file(const char* filepath) noexcept;
     static void compile_spirv(cvk::Context& ctx, cvk::Renderable& gfx, VkShaderModule& module, const shaderc::Compiler& compiler, const shaderc::CompileOptions& options, const std::string& file_dir, const char* file_name, shaderc_shader_kind shader_kind) noexcept;
     static VkDeviceSize map_bytes(VkDeviceSize buffer_size, void* const buffer, VkDeviceSize& offs, std::span<const std::byte> bytes) noexcept;
-    static cvk::Offset find_memtype(std::span<const VkMemoryType> mem_types, cvk::Offset alloc_type, cvk::Offset alloc_props) noexcept;
+    static VkDeviceSize map_indices16(VkDeviceSize buffer_size, void* const buffer, VkDeviceSize& offs, std::span<const cge::Index> indices) noexcept;
+    static VkDeviceSize stream_size(const cvk::Stream& stream) noexcept;
+    static bool is_lent(const cvk::Renderable& gfx, cvk::Offset frame_idx, std::span<const std::byte> bytes) noexcept;
     static VkSurfaceFormatKHR ideal_format(std::span<const VkSurfaceFormatKHR> formats) noexcept;
     static VkPresentModeKHR ideal_present(std::span<const VkPresentModeKHR> modes, bool vsync) noexcept;
     extern VkExtent2D full_resolution(cvk::Context& ctx, cvk::Renderable& gfx, bool update) noexcept;
 
     extern VkResult render_frame(cvk::Context& ctx, cvk::Renderable& gfx, const cge::Scene& scene) noexcept;
+    extern void lend_scene(cvk::Context& ctx, cvk::Renderable& gfx, cge::Scene& scene) noexcept;
     static VkResult acquire_image(cvk::Renderable& gfx, cvk::Offset& acquired_idx, VkSemaphore signal_sem, std::span<const VkFence> wait_fences, std::span<const VkFence> reset_fences) noexcept;
-    static VkResult record_commands(cvk::Renderable& gfx, cvk::Offset frame_idx, const cge::Scene& scene) noexcept;
+    static VkResult record_commands(cvk::Context& ctx, cvk::Renderable& gfx, cvk::Offset frame_idx, const cge::Scene& scene) noexcept;
+    static VkRect2D clip_scissor(const cvk::Renderable& gfx, const cge::Viewport& view, const cge::Scene& scene, cge::uint clip) noexcept;
+    static cvk::DrawConstants draw_constants(const cge::mat4& transform, cge::Color tint) noexcept;
     static VkResult submit_commands(cvk::Renderable& gfx, cvk::Offset frame_idx, std::span<const VkSemaphore> wait_sems, std::span<const VkSemaphore> signal_sems, VkFence signal_fence) noexcept;
     static VkResult present_image(cvk::Renderable& gfx, cvk::Offset frame_idx, std::span<const VkSemaphore> wait_sems) noexcept;
 
@@ -118,6 +140,7 @@ namespace cvk
     void create_context(cvk::Context& ctx) noexcept
     {
         CGE_LOG("[CGE] Initializing Vulkan Context...\n");
+        cvk::reinit_host(ctx);
         cvk::reinit_instance(ctx);
         cvk::load_instance_functions(ctx);
     #if defined(CGE_DEBUG)
@@ -141,6 +164,7 @@ namespace cvk
         cvk::deinit_instance_properties(ctx);
     #endif
         cvk::deinit_instance(ctx);
+        cvk::deinit_host(ctx);
     }
 
     void reinit_instance(cvk::Context& ctx) noexcept
@@ -171,7 +195,7 @@ namespace cvk
             .ppEnabledExtensionNames = cvk::req_instance_extensions.data(),
         };
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateInstance.html
-        const VkResult res_instance{ vkCreateInstance(&create_info, ctx.allocator, &ctx.instance) };
+        const VkResult res_instance{ vkCreateInstance(&create_info, cvk::allocator(ctx, cvk::HostScope::instance), &ctx.instance) };
         CGE_ASSERT(res_instance == VK_SUCCESS);
     }
 
@@ -179,7 +203,7 @@ namespace cvk
     {
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroyInstance.html
         if (ctx.instance)
-            vkDestroyInstance(ctx.instance, ctx.allocator);
+            vkDestroyInstance(ctx.instance, cvk::allocator(ctx, cvk::HostScope::instance));
     }
 
 #if defined(CGE_DEBUG)
@@ -346,7 +370,7 @@ namespace cvk
             .pUserData = {},
         };
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateDebugUtilsMessengerEXT.html
-        const VkResult res_debug{ ctx.pfn.vkCreateDebugUtilsMessengerEXT(ctx.instance, &create_info, ctx.allocator, &ctx.messenger) };
+        const VkResult res_debug{ ctx.pfn.vkCreateDebugUtilsMessengerEXT(ctx.instance, &create_info, cvk::allocator(ctx, cvk::HostScope::instance), &ctx.messenger) };
         CGE_ASSERT(res_debug == VK_SUCCESS);
     }
 
@@ -354,7 +378,7 @@ namespace cvk
     {
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroyDebugUtilsMessengerEXT.html
         if (ctx.messenger)
-            ctx.pfn.vkDestroyDebugUtilsMessengerEXT(ctx.instance, ctx.messenger, ctx.allocator);
+            ctx.pfn.vkDestroyDebugUtilsMessengerEXT(ctx.instance, ctx.messenger, cvk::allocator(ctx, cvk::HostScope::instance));
     }
 
     constexpr const char* debug_msg_severity(const VkDebugUtilsMessageSeverityFlagBitsEXT val) noexcept
@@ -403,10 +427,11 @@ namespace cvk
         CGE_LOG("[CGE] Backbuffers: ({}..{})\n", gfx.ds_capabilities.surfaceCapabilities.minImageCount, gfx.ds_capabilities.surfaceCapabilities.maxImageCount);
         cvk::reinit_device(ctx, gfx);
         cvk::load_device_functions(ctx, gfx);
-        cvk::reinit_buffers(ctx, gfx);
         cvk::reinit_cmdpool(ctx, gfx);
         cvk::reinit_renderpass(ctx, gfx);
         cvk::remake_swapchain(ctx, gfx, vsync);
+        cvk::select_upload_memory(ctx, gfx);
+        cvk::reinit_buffers(ctx, gfx);
         cvk::reinit_shaders(ctx, gfx);
         cvk::reinit_layout(ctx, gfx);
         cvk::reinit_pipelines(ctx, gfx);
@@ -423,10 +448,13 @@ namespace cvk
         cvk::deinit_pipelines(ctx, gfx);
         cvk::deinit_layout(ctx, gfx);
         cvk::deinit_shaders(ctx, gfx);
+        cvk::deinit_meshes(ctx, gfx);
+        cvk::deinit_static(ctx, gfx);
+        cvk::deinit_buffers(ctx, gfx);
         cvk::deinit_swapchain(ctx, gfx, true);
         cvk::deinit_renderpass(ctx, gfx);
         cvk::deinit_cmdpool(ctx, gfx);
-        cvk::deinit_buffers(ctx, gfx);
+        cvk::deinit_memory(ctx, gfx);
         cvk::deinit_device(ctx, gfx);
         cvk::deinit_surface(ctx, gfx);
     }
@@ -451,7 +479,7 @@ namespace cvk
                 .hwnd = static_cast<HWND>(gfx.window),
             };
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateWin32SurfaceKHR.html
-            const VkResult res_surface{ vkCreateWin32SurfaceKHR(ctx.instance, &create_info, ctx.allocator, &gfx.surface) };
+            const VkResult res_surface{ vkCreateWin32SurfaceKHR(ctx.instance, &create_info, cvk::allocator(ctx, cvk::HostScope::instance), &gfx.surface) };
         #elif defined(WYN_XLIB)
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkXlibSurfaceCreateInfoKHR.html
             const VkXlibSurfaceCreateInfoKHR create_info{
@@ -462,7 +490,7 @@ namespace cvk
                 .window = static_cast<Window>(std::uintptr_t(gfx.window)),
             };
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateXlibSurfaceKHR.html
-            const VkResult res_surface{ vkCreateXlibSurfaceKHR(ctx.instance, &create_info, ctx.allocator, &gfx.surface) };
+            const VkResult res_surface{ vkCreateXlibSurfaceKHR(ctx.instance, &create_info, cvk::allocator(ctx, cvk::HostScope::instance), &gfx.surface) };
         #elif defined(WYN_XCB) || defined(WYN_X11)
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkXcbSurfaceCreateInfoKHR.html
             const VkXcbSurfaceCreateInfoKHR create_info{
@@ -473,7 +501,7 @@ namespace cvk
                 .window = static_cast<xcb_window_t>(std::uintptr_t(gfx.window)),
             };
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateXcbSurfaceKHR.html
-            const VkResult res_surface{ vkCreateXcbSurfaceKHR(ctx.instance, &create_info, ctx.allocator, &gfx.surface) };
+            const VkResult res_surface{ vkCreateXcbSurfaceKHR(ctx.instance, &create_info, cvk::allocator(ctx, cvk::HostScope::instance), &gfx.surface) };
         #elif defined(WYN_WAYLAND)
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkWaylandSurfaceCreateInfoKHR.html
             const VkWaylandSurfaceCreateInfoKHR create_info{
@@ -484,7 +512,7 @@ namespace cvk
                 .surface = static_cast<wl_surface*>(gfx.window),
             };
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateWaylandSurfaceKHR.html
-            const VkResult res_surface{ vkCreateWaylandSurfaceKHR(ctx.instance, &create_info, ctx.allocator, &gfx.surface) };
+            const VkResult res_surface{ vkCreateWaylandSurfaceKHR(ctx.instance, &create_info, cvk::allocator(ctx, cvk::HostScope::instance), &gfx.surface) };
         #elif defined(WYN_COCOA)
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkMetalSurfaceCreateInfoEXT.html
             const VkMetalSurfaceCreateInfoEXT create_info{
@@ -494,7 +522,7 @@ namespace cvk
                 .pLayer = static_cast<const CAMetalLayer*>(cvk::create_metal_layer(gfx.context)),
             };
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateMetalSurfaceEXT.html
-            const VkResult res_surface{ vkCreateMetalSurfaceEXT(ctx.instance, &create_info, ctx.allocator, &gfx.surface) };
+            const VkResult res_surface{ vkCreateMetalSurfaceEXT(ctx.instance, &create_info, cvk::allocator(ctx, cvk::HostScope::instance), &gfx.surface) };
         #else
             #error "Unimplemented"
         #endif
@@ -506,7 +534,7 @@ namespace cvk
     {
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroySurfaceKHR.html
         if (gfx.surface)
-            vkDestroySurfaceKHR(ctx.instance, gfx.surface, ctx.allocator);
+            vkDestroySurfaceKHR(ctx.instance, gfx.surface, cvk::allocator(ctx, cvk::HostScope::instance));
     }
 
     void update_surface_info(cvk::Context& ctx, cvk::Renderable& gfx, const cvk::Offset device_idx, const bool vsync) noexcept
@@ -561,31 +589,28 @@ namespace cvk
 
     void reinit_device(cvk::Context& ctx, cvk::Renderable& gfx) noexcept
     {
-        constexpr std::array graphics_prios{ 1.0f };
-        constexpr std::array present_prios{ 1.0f };
+        constexpr std::array queue_prios{ 1.0f };
 
-        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDeviceQueueCreateInfo.html
-        const std::array queues_info{
-            VkDeviceQueueCreateInfo{
-                .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-                .pNext = {},
-                .flags = {},
-                .queueFamilyIndex = gfx.sel_graphics,
-                .queueCount = static_cast<cvk::Offset>(graphics_prios.size()),
-                .pQueuePriorities = graphics_prios.data(),
-            },
-            VkDeviceQueueCreateInfo{
+        const std::array queue_families{ gfx.sel_graphics, gfx.sel_present, gfx.sel_transfer };
+        std::array<VkDeviceQueueCreateInfo, 3> queues_info{};
+        cvk::Offset queue_unique_count{};
+
+        for (const cvk::Offset family : queue_families)
+        {
+            const auto begin{ queues_info.begin() };
+            const auto end{ begin + queue_unique_count };
+            if (std::ranges::find(begin, end, family, &VkDeviceQueueCreateInfo::queueFamilyIndex) != end) continue;
+
+            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDeviceQueueCreateInfo.html
+            queues_info[queue_unique_count++] = VkDeviceQueueCreateInfo{
                 .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
                 .pNext = {},
                 .flags = {},
-                .queueFamilyIndex = gfx.sel_present,
-                .queueCount = static_cast<cvk::Offset>(present_prios.size()),
-                .pQueuePriorities = present_prios.data(),
-            },
-        };
-
-        const bool queues_unique{ gfx.sel_graphics != gfx.sel_present };
-        const cvk::Offset queue_unique_count{ static_cast<cvk::Offset>(queues_unique ? 2 : 1) };
+                .queueFamilyIndex = family,
+                .queueCount = static_cast<cvk::Offset>(queue_prios.size()),
+                .pQueuePriorities = queue_prios.data(),
+            };
+        }
 
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDeviceCreateInfo.html
         const VkDeviceCreateInfo device_info{
@@ -601,12 +626,13 @@ namespace cvk
             .pEnabledFeatures = &cvk::req_features,
         };
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateDevice.html
-        const VkResult res_device{ vkCreateDevice(ctx.devices[gfx.sel_device], &device_info, ctx.allocator, &gfx.device) };
+        const VkResult res_device{ vkCreateDevice(ctx.devices[gfx.sel_device], &device_info, cvk::allocator(ctx, cvk::HostScope::device), &gfx.device) };
         CGE_ASSERT(res_device == VK_SUCCESS);
 
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkGetDeviceQueue.html
         vkGetDeviceQueue(gfx.device, gfx.sel_graphics, 0, &gfx.queue_graphics);
         vkGetDeviceQueue(gfx.device, gfx.sel_present, 0, &gfx.queue_present);
+        vkGetDeviceQueue(gfx.device, gfx.sel_transfer, 0, &gfx.queue_transfer);
     }
 
     void deinit_device(cvk::Context& ctx [[maybe_unused]], cvk::Renderable& gfx) noexcept
@@ -616,70 +642,500 @@ namespace cvk
 
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroyDevice.html        
         if (gfx.device)
-            vkDestroyDevice(gfx.device, ctx.allocator);
+            vkDestroyDevice(gfx.device, cvk::allocator(ctx, cvk::HostScope::device));
     }
 
-    void reinit_buffers(cvk::Context& ctx, cvk::Renderable& gfx) noexcept
+    void select_upload_memory(cvk::Context& ctx, cvk::Renderable& gfx) noexcept
     {
+        const VkPhysicalDeviceMemoryProperties& mem_props{ ctx.device_memory[gfx.sel_device] };
+
+        constexpr VkMemoryPropertyFlags coherent{ VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
+        constexpr VkMemoryPropertyFlags cached{ VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT };
+
+        const auto has_memtype = [&](const VkMemoryPropertyFlags props) -> bool {
+            for (cvk::Offset memtype{}; memtype < mem_props.memoryTypeCount; ++memtype)
+            {
+                if ((mem_props.memoryTypes[memtype].propertyFlags & props) == props) return true;
+            }
+            return false;
+        };
+
+        if constexpr (cvk::upload_memory == cvk::UploadMemory::coherent)
         {
-            constexpr VkDeviceSize MiB{ VkDeviceSize(1) << 20 };
-            gfx.buffer_capacity = 1 * MiB;
+            gfx.upload_memprops = coherent;
+        }
+        else if constexpr (cvk::upload_memory == cvk::UploadMemory::cached)
+        {
+            gfx.upload_memprops = has_memtype(cached) ? cached : coherent;
+        }
+        else
+        {
+            gfx.upload_memprops = has_memtype(cached | coherent) ? (cached | coherent) : coherent;
+        }
+
+        CGE_LOG("[CGE] Upload memory: {}, {}\n",
+            (gfx.upload_memprops & VK_MEMORY_PROPERTY_HOST_CACHED_BIT) ? "cached" : "uncached",
+            (gfx.upload_memprops & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) ? "coherent" : "flushed if non-coherent"
+        );
+    }
+
+    void reinit_buffers(cvk::Context& ctx, cvk::Renderable& gfx) noexcept
+    {
+        constexpr VkDeviceSize MiB{ VkDeviceSize(1) << 20 };
+        const cvk::Offset num_regions{ std::max(gfx.frame_count, cvk::Offset{ 1 }) };
+        gfx.buffer_region = std::max(gfx.buffer_region, 1 * MiB);
+        gfx.buffer_capacity = gfx.buffer_region * num_regions;
+
+        constexpr VkBufferUsageFlags usage{ VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT };
+        const VkResult res_create{ cvk::create_buffer(ctx, gfx, gfx.buffer_capacity, usage, gfx.upload_memprops, {}, cvk::Strategy::tlsf, gfx.buffer_main, gfx.buffer_memory, gfx.buffer_memreqs, gfx.buffer_mapped) };
+        CGE_ASSERT(res_create == VK_SUCCESS);
+    }
+
+    void deinit_buffers(cvk::Context& ctx [[maybe_unused]], cvk::Renderable& gfx) noexcept
+    {
+        cvk::destroy_buffer(ctx, gfx, gfx.buffer_retired, gfx.buffer_retired_memory, gfx.buffer_retired_mapped);
+        gfx.buffer_retired_frames = {};
+
+        cvk::destroy_buffer(ctx, gfx, gfx.buffer_main, gfx.buffer_memory, gfx.buffer_mapped);
+        gfx.buffer_capacity = {};
+    }
 
+    VkResult create_buffer(cvk::Context& ctx, cvk::Renderable& gfx, const VkDeviceSize size, const VkBufferUsageFlags usage, const VkMemoryPropertyFlags props, const std::span<const cvk::Offset> families, const cvk::Strategy strategy, VkBuffer& buffer, cvk::Allocation& memory, VkMemoryRequirements& memreqs, void*& mapped) noexcept
+    {
+        const bool concurrent{ families.size() > 1 };
+
+        {
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkBufferCreateInfo.html
             const VkBufferCreateInfo buffer_info{
                 .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
                 .pNext = {},
                 .flags = {},
-                .size = gfx.buffer_capacity,
-                .usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-                .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-                .queueFamilyIndexCount = {},
-                .pQueueFamilyIndices = {},
+                .size = size,
+                .usage = usage,
+                .sharingMode = concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE,
+                .queueFamilyIndexCount = concurrent ? static_cast<cvk::Offset>(families.size()) : 0,
+                .pQueueFamilyIndices = concurrent ? families.data() : nullptr,
             };
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateBuffer.html
-            const VkResult res_buffer{ vkCreateBuffer(gfx.device, &buffer_info, ctx.allocator, &gfx.buffer_main) };
-            CGE_ASSERT(res_buffer == VK_SUCCESS);
+            const VkResult res_buffer{ vkCreateBuffer(gfx.device, &buffer_info, cvk::allocator(ctx, cvk::HostScope::resource), &buffer) };
+            if (res_buffer != VK_SUCCESS) return res_buffer;
 
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkGetBufferMemoryRequirements.html
-            vkGetBufferMemoryRequirements(gfx.device, gfx.buffer_main, &gfx.buffer_memreqs);
+            vkGetBufferMemoryRequirements(gfx.device, buffer, &memreqs);
         }
         {
-            const VkDeviceSize alloc_size{ gfx.buffer_capacity };
-            const cvk::Offset alloc_type{ gfx.buffer_memreqs.memoryTypeBits };
-            constexpr VkMemoryPropertyFlags alloc_props{ VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
-            
-            const VkPhysicalDeviceMemoryProperties& mem_props{ ctx.device_memory[gfx.sel_device] };
-            const std::span<const VkMemoryType> mem_types{ mem_props.memoryTypes, mem_props.memoryTypeCount };
-            const cvk::Offset mem_idx{ cvk::find_memtype(mem_types, alloc_type, alloc_props) };
-            CGE_ASSERT(mem_idx != null_idx);
-
-            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkMemoryAllocateInfo.html
-            const VkMemoryAllocateInfo alloc_info{
-                .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-                .pNext = {},
-                .allocationSize = alloc_size,
-                .memoryTypeIndex = mem_idx,
-            };
-            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkAllocateMemory.html
-            const VkResult res_alloc{ vkAllocateMemory(gfx.device, &alloc_info, ctx.allocator, &gfx.buffer_memory) };
-            CGE_ASSERT(res_alloc == VK_SUCCESS);
+            const VkResult res_alloc{ cvk::allocate_memory(ctx, gfx, memreqs, props, strategy, memory) };
+            if (res_alloc != VK_SUCCESS)
+            {
+                cvk::destroy_buffer(ctx, gfx, buffer, memory, mapped);
+                return res_alloc;
+            }
         }
         {
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkBindBufferMemory.html
-            const VkResult res_bind{ vkBindBufferMemory(gfx.device, gfx.buffer_main, gfx.buffer_memory, 0) };
-            CGE_ASSERT(res_bind == VK_SUCCESS);
+            const VkResult res_bind{ vkBindBufferMemory(gfx.device, buffer, memory.memory, memory.offset) };
+            if (res_bind != VK_SUCCESS)
+            {
+                cvk::destroy_buffer(ctx, gfx, buffer, memory, mapped);
+                return res_bind;
+            }
         }
+        // Host-visible heaps stay mapped for their whole lifetime.
+        mapped = memory.mapped;
+        CGE_ASSERT(!(props & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) || mapped);
+        return VK_SUCCESS;
     }
 
-    void deinit_buffers(cvk::Context& ctx [[maybe_unused]], cvk::Renderable& gfx) noexcept
+    void destroy_buffer(cvk::Context& ctx [[maybe_unused]], cvk::Renderable& gfx, VkBuffer& buffer, cvk::Allocation& memory, void*& mapped) noexcept
     {
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroyBuffer.html
-        if (gfx.buffer_main)
-            vkDestroyBuffer(gfx.device, gfx.buffer_main, ctx.allocator);
+        if (buffer)
+            vkDestroyBuffer(gfx.device, buffer, cvk::allocator(ctx, cvk::HostScope::resource));
+
+        // A later buffer may reuse the handle, so commands recorded against this one can not be told apart by it.
+        if (buffer)
+            ++gfx.command_epoch;
         
-        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkFreeMemory.html
-        if (gfx.buffer_memory)
-            vkFreeMemory(gfx.device, gfx.buffer_memory, ctx.allocator);
+        cvk::free_memory(ctx, gfx, memory);
+
+        mapped = {};
+        buffer = {};
+    }
+
+    VkResult grow_buffers(cvk::Context& ctx, cvk::Renderable& gfx, const cvk::Offset frame_idx, const VkDeviceSize required) noexcept
+    {
+        CGE_ASSERT(gfx.frame_count <= 64);
+
+        VkDeviceSize new_region{ gfx.buffer_region };
+        while ((new_region < required) && (new_region < cvk::max_buffer_region)) new_region *= 2;
+        new_region = std::min(new_region, cvk::max_buffer_region);
+        if (new_region <= gfx.buffer_region) return VK_INCOMPLETE;
+
+        if (gfx.buffer_retired)
+        {
+            // Only one generation is kept alive, so wait out the frames still reading the older one.
+            const VkResult res_wait{ cvk::wait_frames(gfx, gfx.buffer_retired_frames) };
+            if (res_wait != VK_SUCCESS) return res_wait;
+
+            cvk::destroy_buffer(ctx, gfx, gfx.buffer_retired, gfx.buffer_retired_memory, gfx.buffer_retired_mapped);
+            gfx.buffer_retired_frames = {};
+        }
+
+        const VkDeviceSize new_capacity{ new_region * std::max(gfx.frame_count, cvk::Offset{ 1 }) };
+
+        VkBuffer new_buffer{};
+        cvk::Allocation new_memory{};
+        VkMemoryRequirements new_memreqs{};
+        void* new_mapped{};
+
+        constexpr VkBufferUsageFlags usage{ VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT };
+        const VkResult res_create{ cvk::create_buffer(ctx, gfx, new_capacity, usage, gfx.upload_memprops, {}, cvk::Strategy::tlsf, new_buffer, new_memory, new_memreqs, new_mapped) };
+        if (res_create != VK_SUCCESS) return res_create;
+
+        CGE_LOG("[CGE] Upload buffer grown: {} -> {} bytes per frame\n", gfx.buffer_region, new_region);
+
+        // Every other frame may still be reading its region of the old buffer.
+        const std::uint64_t all_frames{ (gfx.frame_count >= 64) ? ~std::uint64_t{} : ((std::uint64_t(1) << gfx.frame_count) - 1) };
+        gfx.buffer_retired = gfx.buffer_main;
+        gfx.buffer_retired_memory = gfx.buffer_memory;
+        gfx.buffer_retired_mapped = gfx.buffer_mapped;
+        gfx.buffer_retired_frames = all_frames & ~(std::uint64_t(1) << frame_idx);
+
+        gfx.buffer_main = new_buffer;
+        gfx.buffer_memory = new_memory;
+        gfx.buffer_memreqs = new_memreqs;
+        gfx.buffer_mapped = new_mapped;
+        gfx.buffer_region = new_region;
+        gfx.buffer_capacity = new_capacity;
+
+        return VK_SUCCESS;
+    }
+
+    VkResult wait_frames(cvk::Renderable& gfx, const std::uint64_t frames) noexcept
+    {
+        CGE_ASSERT(gfx.frame_count <= 64);
+
+        std::array<VkFence, 64> fences{};
+        cvk::Offset fence_count{};
+        for (cvk::Offset idx{}; idx < gfx.frame_count; ++idx)
+        {
+            if (frames & (std::uint64_t(1) << idx))
+                fences[fence_count++] = gfx.frame_fence[idx];
+        }
+        if (fence_count == 0) return VK_SUCCESS;
+
+        constexpr std::uint64_t no_timeout{ std::uint64_t(~0) };
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkWaitForFences.html
+        return vkWaitForFences(gfx.device, fence_count, fences.data(), VK_TRUE, no_timeout);
+    }
+
+    void deinit_static(cvk::Context& ctx, cvk::Renderable& gfx) noexcept
+    {
+        void* mapped{};
+        cvk::destroy_buffer(ctx, gfx, gfx.static_buffer, gfx.static_memory, mapped);
+
+        gfx.static_idx_offs = {};
+        gfx.static_vtx_count = {};
+        gfx.static_idx_count = {};
+        gfx.static_revision = {};
+    }
+
+    VkResult upload_static(cvk::Context& ctx, cvk::Renderable& gfx, const cvk::Offset frame_idx, const cge::Scene& scene) noexcept
+    {
+        {
+            // The other frames-in-flight may still be drawing the previous static geometry.
+            const std::uint64_t all_frames{ (gfx.frame_count >= 64) ? ~std::uint64_t{} : ((std::uint64_t(1) << gfx.frame_count) - 1) };
+            const VkResult res_wait{ cvk::wait_frames(gfx, all_frames & ~(std::uint64_t(1) << frame_idx)) };
+            if (res_wait != VK_SUCCESS) return res_wait;
+
+            cvk::deinit_static(ctx, gfx);
+        }
+
+        const VkResult result{ cvk::upload_resident(ctx, gfx, scene.static_vertices, scene.static_indices, gfx.static_buffer, gfx.static_memory, gfx.static_idx_offs, gfx.static_idx_type) };
+        if (result != VK_SUCCESS)
+        {
+            cvk::deinit_static(ctx, gfx);
+            return result;
+        }
+
+        gfx.static_vtx_count = static_cast<cvk::Offset>(scene.static_vertices.size());
+        gfx.static_idx_count = static_cast<cvk::Offset>(scene.static_indices.size());
+        gfx.static_revision = scene.static_revision;
+
+        if (gfx.static_buffer)
+            CGE_LOG("[CGE] Static geometry uploaded: {} vertices, {} indices\n", gfx.static_vtx_count, gfx.static_idx_count);
+        return VK_SUCCESS;
+    }
+
+    VkResult upload_resident(cvk::Context& ctx, cvk::Renderable& gfx, const std::span<const cge::Vertex> vtx_list, const std::span<const cge::Index> idx_list, VkBuffer& buffer, cvk::Allocation& memory, VkDeviceSize& idx_offs, VkIndexType& idx_type) noexcept
+    {
+        const bool narrow{ vtx_list.size() <= cvk::max_index16_vertices };
+        const cvk::Stream vtx_stream{ .bytes = std::as_bytes(vtx_list), .narrow = false };
+        const cvk::Stream idx_stream{ .bytes = std::as_bytes(idx_list), .narrow = narrow };
+        const VkDeviceSize vtx_size{ cvk::stream_size(vtx_stream) };
+        const VkDeviceSize idx_size{ cvk::stream_size(idx_stream) };
+        const VkDeviceSize total_size{ vtx_size + idx_size };
+
+        if (total_size == 0) return VK_SUCCESS;
+
+        VkBuffer staging_buffer{};
+        cvk::Allocation staging_memory{};
+        VkMemoryRequirements staging_memreqs{};
+        void* staging_mapped{};
+        {
+            const VkResult res_staging{ cvk::create_buffer(ctx, gfx, total_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, gfx.upload_memprops, {}, cvk::Strategy::linear, staging_buffer, staging_memory, staging_memreqs, staging_mapped) };
+            if (res_staging != VK_SUCCESS) return res_staging;
+
+            VkDeviceSize offset{};
+            (void)cvk::map_bytes(total_size, staging_mapped, offset, vtx_stream.bytes);
+            if (narrow)
+                (void)cvk::map_indices16(total_size, staging_mapped, offset, idx_list);
+            else
+                (void)cvk::map_bytes(total_size, staging_mapped, offset, idx_stream.bytes);
+
+            const VkResult res_flush{ cvk::flush_memory(ctx, gfx, staging_memory, 0, total_size) };
+            if (res_flush != VK_SUCCESS)
+            {
+                cvk::destroy_buffer(ctx, gfx, staging_buffer, staging_memory, staging_mapped);
+                return res_flush;
+            }
+        }
+
+        VkResult result{};
+        {
+            // The buffer is shared by both queues, so no ownership transfer is needed.
+            const std::array families{ gfx.sel_graphics, gfx.sel_transfer };
+            const std::span<const cvk::Offset> sharing{ families.data(), (gfx.sel_graphics != gfx.sel_transfer) ? families.size() : 1 };
+
+            constexpr VkBufferUsageFlags usage{ VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT };
+            VkMemoryRequirements memreqs{};
+            void* mapped{};
+            result = cvk::create_buffer(ctx, gfx, total_size, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sharing, cvk::Strategy::tlsf, buffer, memory, memreqs, mapped);
+        }
+        if (result == VK_SUCCESS)
+        {
+            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkBufferCopy.html
+            const VkBufferCopy region{
+                .srcOffset = 0,
+                .dstOffset = 0,
+                .size = total_size,
+            };
+
+            result = cvk::single_commands(ctx, gfx, gfx.transfer_pool, gfx.queue_transfer, [&](const VkCommandBuffer command_buffer){
+                // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdCopyBuffer.html
+                vkCmdCopyBuffer(command_buffer, staging_buffer, buffer, 1, &region);
+            });
+        }
+
+        cvk::destroy_buffer(ctx, gfx, staging_buffer, staging_memory, staging_mapped);
+
+        if (result != VK_SUCCESS)
+        {
+            void* mapped{};
+            cvk::destroy_buffer(ctx, gfx, buffer, memory, mapped);
+            return result;
+        }
+
+        idx_offs = vtx_size;
+        idx_type = narrow ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+        return VK_SUCCESS;
+    }
+
+    void deinit_meshes(cvk::Context& ctx, cvk::Renderable& gfx) noexcept
+    {
+        for (cvk::ResidentMesh& mesh : gfx.meshes)
+        {
+            void* mapped{};
+            cvk::destroy_buffer(ctx, gfx, mesh.buffer, mesh.memory, mapped);
+        }
+        gfx.meshes.clear();
+        gfx.mesh_revision = {};
+    }
+
+    VkResult upload_meshes(cvk::Context& ctx, cvk::Renderable& gfx, const cvk::Offset frame_idx, const cge::Scene& scene) noexcept
+    {
+        if (gfx.meshes.size() < scene.meshes.size())
+            gfx.meshes.resize(scene.meshes.size());
+
+        bool waited{};
+        for (std::size_t mesh_idx{}; mesh_idx < scene.meshes.size(); ++mesh_idx)
+        {
+            const cge::MeshData& data{ scene.meshes[mesh_idx] };
+            cvk::ResidentMesh& mesh{ gfx.meshes[mesh_idx] };
+            if (mesh.revision == data.revision) continue;
+
+            if (mesh.buffer && !waited)
+            {
+                // The other frames-in-flight may still be drawing the meshes about to be replaced.
+                const std::uint64_t all_frames{ (gfx.frame_count >= 64) ? ~std::uint64_t{} : ((std::uint64_t(1) << gfx.frame_count) - 1) };
+                const VkResult res_wait{ cvk::wait_frames(gfx, all_frames & ~(std::uint64_t(1) << frame_idx)) };
+                if (res_wait != VK_SUCCESS) return res_wait;
+                waited = true;
+            }
+
+            void* mapped{};
+            cvk::destroy_buffer(ctx, gfx, mesh.buffer, mesh.memory, mapped);
+            mesh = cvk::ResidentMesh{};
+
+            if (data.live)
+            {
+                const VkResult res_upload{ cvk::upload_resident(ctx, gfx, data.vertices, data.indices, mesh.buffer, mesh.memory, mesh.idx_offs, mesh.idx_type) };
+                if (res_upload == VK_SUCCESS)
+                {
+                    mesh.vtx_count = static_cast<cvk::Offset>(data.vertices.size());
+                    mesh.idx_count = static_cast<cvk::Offset>(data.indices.size());
+                }
+                else
+                {
+                    // Do not retry every frame. The mesh is skipped until the game recreates it.
+                    CGE_LOG("[CGE] Mesh {} upload failed.\n", mesh_idx + 1);
+                }
+            }
+            mesh.revision = data.revision;
+        }
+
+        gfx.mesh_revision = scene.mesh_revision;
+        return VK_SUCCESS;
+    }
+
+    void release_buffers(cvk::Context& ctx, cvk::Renderable& gfx, const cvk::Offset frame_idx) noexcept
+    {
+        if (!gfx.buffer_retired) return;
+
+        gfx.buffer_retired_frames &= ~(std::uint64_t(1) << frame_idx);
+        if (gfx.buffer_retired_frames != 0) return;
+
+        cvk::destroy_buffer(ctx, gfx, gfx.buffer_retired, gfx.buffer_retired_memory, gfx.buffer_retired_mapped);
+    }
+
+    VkResult upload_geometry(cvk::Context& ctx, cvk::Renderable& gfx, const cvk::Offset frame_idx, const std::span<const cvk::Stream> streams, const std::span<VkBuffer> buffers, const std::span<VkDeviceSize> offsets) noexcept
+    {
+        CGE_ASSERT(buffers.size() == streams.size());
+        CGE_ASSERT(offsets.size() == streams.size());
+
+        CGE_ASSERT(streams.size() <= cvk::num_streams);
+
+        // Streams that the Scene built straight into this frame's region are already in place.
+        std::array<bool, cvk::num_streams> lent{};
+        bool any_lent{};
+
+        VkDeviceSize total_size{};
+        for (std::size_t idx{}; idx < streams.size(); ++idx)
+        {
+            lent[idx] = cvk::is_lent(gfx, frame_idx, streams[idx].bytes);
+            any_lent |= lent[idx];
+            total_size += cvk::stream_size(streams[idx]) + (cvk::stream_align - 1);
+        }
+
+        // Growing would retire the buffer that the lent streams live in.
+        if ((total_size > gfx.buffer_region) && !any_lent)
+        {
+            // On failure, the streams that do not fit are spilled into the frame's overflow buffer below.
+            const VkResult res_grow{ cvk::grow_buffers(ctx, gfx, frame_idx, total_size) };
+            (void)res_grow;
+        }
+
+        const VkDeviceSize region_offs{ gfx.buffer_region * frame_idx };
+        const VkDeviceSize region_size{ gfx.buffer_region };
+        CGE_ASSERT(region_offs + region_size <= gfx.buffer_capacity);
+
+        // The rest of the region is lent out, so every other stream goes to the overflow buffer.
+        VkDeviceSize region_used{ any_lent ? region_size : 0 };
+        VkDeviceSize spill_used{};
+
+        const auto align_stream = [](const VkDeviceSize offs) -> VkDeviceSize {
+            return (offs + cvk::stream_align - 1) & ~(cvk::stream_align - 1);
+        };
+
+        for (std::size_t idx{}; idx < streams.size(); ++idx)
+        {
+            const VkDeviceSize size{ cvk::stream_size(streams[idx]) };
+            if (lent[idx])
+            {
+                buffers[idx] = gfx.buffer_main;
+                offsets[idx] = static_cast<VkDeviceSize>(streams[idx].bytes.data() - static_cast<const std::byte*>(gfx.buffer_mapped));
+            }
+            else if (align_stream(region_used) + size <= region_size)
+            {
+                buffers[idx] = gfx.buffer_main;
+                offsets[idx] = align_stream(region_used);
+                region_used = offsets[idx] + size;
+            }
+            else
+            {
+                buffers[idx] = VK_NULL_HANDLE;
+                offsets[idx] = align_stream(spill_used);
+                spill_used = offsets[idx] + size;
+            }
+        }
+
+        if (spill_used > gfx.frame_overflow_capacity[frame_idx])
+        {
+            // Only this frame uses its overflow buffer, and its fence has already been waited on.
+            cvk::destroy_buffer(ctx, gfx, gfx.frame_overflow[frame_idx], gfx.frame_overflow_memory[frame_idx], gfx.frame_overflow_mapped[frame_idx]);
+            gfx.frame_overflow_capacity[frame_idx] = {};
+
+            const VkDeviceSize new_capacity{ std::bit_ceil(spill_used) };
+            VkMemoryRequirements memreqs{};
+
+            constexpr VkBufferUsageFlags usage{ VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT };
+            const VkResult res_create{ cvk::create_buffer(ctx, gfx, new_capacity, usage, gfx.upload_memprops, {}, cvk::Strategy::buddy, gfx.frame_overflow[frame_idx], gfx.frame_overflow_memory[frame_idx], memreqs, gfx.frame_overflow_mapped[frame_idx]) };
+            if (res_create != VK_SUCCESS) return res_create;
+
+            gfx.frame_overflow_capacity[frame_idx] = new_capacity;
+        }
+
+        void* const region{ static_cast<std::byte*>(gfx.buffer_mapped) + region_offs };
+        void* const spill{ gfx.frame_overflow_mapped[frame_idx] };
+
+        for (std::size_t idx{}; idx < streams.size(); ++idx)
+        {
+            if (lent[idx]) continue;
+
+            const bool in_region{ buffers[idx] == gfx.buffer_main };
+            const VkDeviceSize dst_size{ in_region ? region_size : gfx.frame_overflow_capacity[frame_idx] };
+            void* const dst{ in_region ? region : spill };
+            const VkDeviceSize dst_base{ in_region ? region_offs : 0 };
+
+            VkDeviceSize offset{ offsets[idx] };
+            if (streams[idx].narrow)
+            {
+                const std::span<const cge::Index> indices{ reinterpret_cast<const cge::Index*>(streams[idx].bytes.data()), streams[idx].bytes.size() / sizeof(cge::Index) };
+                offsets[idx] = dst_base + cvk::map_indices16(dst_size, dst, offset, indices);
+            }
+            else
+            {
+                offsets[idx] = dst_base + cvk::map_bytes(dst_size, dst, offset, streams[idx].bytes);
+            }
+
+            if (!in_region) buffers[idx] = gfx.frame_overflow[frame_idx];
+        }
+
+        {
+            // Non-coherent memory only sees this frame's writes once they are flushed, so flush just the bytes written.
+            VkDeviceSize flush_beg{ region_offs + region_size };
+            VkDeviceSize flush_end{ region_offs };
+            for (std::size_t idx{}; idx < streams.size(); ++idx)
+            {
+                const VkDeviceSize size{ cvk::stream_size(streams[idx]) };
+                if ((buffers[idx] != gfx.buffer_main) || (size == 0)) continue;
+
+                flush_beg = std::min(flush_beg, offsets[idx]);
+                flush_end = std::max(flush_end, offsets[idx] + size);
+            }
+
+            if (flush_beg < flush_end)
+            {
+                const VkResult res_flush{ cvk::flush_memory(ctx, gfx, gfx.buffer_memory, flush_beg, flush_end - flush_beg) };
+                if (res_flush != VK_SUCCESS) return res_flush;
+            }
+
+            const VkResult res_spill{ cvk::flush_memory(ctx, gfx, gfx.frame_overflow_memory[frame_idx], 0, spill_used) };
+            if (res_spill != VK_SUCCESS) return res_spill;
+        }
+
+        return VK_SUCCESS;
     }
 
     void reinit_cmdpool(cvk::Context& ctx [[maybe_unused]], cvk::Renderable& gfx) noexcept
@@ -692,15 +1148,29 @@ namespace cvk
             .queueFamilyIndex = gfx.sel_graphics,
         };
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateCommandPool.html
-        const VkResult res_pool{ vkCreateCommandPool(gfx.device, &pool_info, ctx.allocator, &gfx.command_pool) };
+        const VkResult res_pool{ vkCreateCommandPool(gfx.device, &pool_info, cvk::allocator(ctx, cvk::HostScope::device), &gfx.command_pool) };
         CGE_ASSERT(res_pool == VK_SUCCESS);
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkCommandPoolCreateInfo.html
+        const VkCommandPoolCreateInfo transfer_info{
+            .sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+            .pNext = {},
+            .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+            .queueFamilyIndex = gfx.sel_transfer,
+        };
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateCommandPool.html
+        const VkResult res_transfer{ vkCreateCommandPool(gfx.device, &transfer_info, cvk::allocator(ctx, cvk::HostScope::device), &gfx.transfer_pool) };
+        CGE_ASSERT(res_transfer == VK_SUCCESS);
     }
 
     void deinit_cmdpool(cvk::Context& ctx [[maybe_unused]], cvk::Renderable& gfx) noexcept
     {
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroyCommandPool.html
+        if (gfx.transfer_pool)
+            vkDestroyCommandPool(gfx.device, gfx.transfer_pool, cvk::allocator(ctx, cvk::HostScope::device));
+
         if (gfx.command_pool)
-            vkDestroyCommandPool(gfx.device, gfx.command_pool, ctx.allocator);
+            vkDestroyCommandPool(gfx.device, gfx.command_pool, cvk::allocator(ctx, cvk::HostScope::device));
     }
 
     void reinit_shaders(cvk::Context& ctx [[maybe_unused]], cvk::Renderable& gfx) noexcept
@@ -710,6 +1180,8 @@ namespace cvk
 
         const std::string file_dir{ "shaders/glsl/" };
         cvk::compile_spirv(ctx, gfx, gfx.module_vertex, compiler, options, file_dir, "shader.vert", shaderc_shader_kind::shaderc_vertex_shader);
+        cvk::compile_spirv(ctx, gfx, gfx.module_vertex_2d, compiler, options, file_dir, "shader2d.vert", shaderc_shader_kind::shaderc_vertex_shader);
+        cvk::compile_spirv(ctx, gfx, gfx.module_vertex_sprite, compiler, options, file_dir, "sprite.vert", shaderc_shader_kind::shaderc_vertex_shader);
         cvk::compile_spirv(ctx, gfx, gfx.module_fragment, compiler, options, file_dir, "shader.frag", shaderc_shader_kind::shaderc_fragment_shader);
     }
 
@@ -717,14 +1189,33 @@ namespace cvk
     {
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroyShaderModule.html
         if (gfx.module_fragment)
-            vkDestroyShaderModule(gfx.device, gfx.module_fragment, ctx.allocator);
-        
+            vkDestroyShaderModule(gfx.device, gfx.module_fragment, cvk::allocator(ctx, cvk::HostScope::pipeline));
+
+        if (gfx.module_vertex_sprite)
+            vkDestroyShaderModule(gfx.device, gfx.module_vertex_sprite, cvk::allocator(ctx, cvk::HostScope::pipeline));
+
+        if (gfx.module_vertex_2d)
+            vkDestroyShaderModule(gfx.device, gfx.module_vertex_2d, cvk::allocator(ctx, cvk::HostScope::pipeline));
+
         if (gfx.module_vertex)
-            vkDestroyShaderModule(gfx.device, gfx.module_vertex, ctx.allocator);
+            vkDestroyShaderModule(gfx.device, gfx.module_vertex, cvk::allocator(ctx, cvk::HostScope::pipeline));
     }
 
     void reinit_renderpass(cvk::Context& ctx [[maybe_unused]], cvk::Renderable& gfx) noexcept
     {
+        gfx.depth_format = cvk::depth_formats.back();
+        for (const VkFormat format : cvk::depth_formats)
+        {
+            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkGetPhysicalDeviceFormatProperties.html
+            VkFormatProperties props;
+            vkGetPhysicalDeviceFormatProperties(ctx.devices[gfx.sel_device], format, &props);
+            if (props.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT)
+            {
+                gfx.depth_format = format;
+                break;
+            }
+        }
+
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkAttachmentDescription.html
         const VkAttachmentDescription attachment_desc{
             .flags = {},
@@ -737,11 +1228,31 @@ namespace cvk
             .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
             .finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
         };
+        // The depth buffer only lives for the duration of the pass, so it is never stored.
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkAttachmentDescription.html
+        const VkAttachmentDescription depth_desc{
+            .flags = {},
+            .format = gfx.depth_format,
+            .samples = VK_SAMPLE_COUNT_1_BIT,
+            .loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+            .storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+            .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+            .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            .finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        };
+        const std::array attachment_descs{ attachment_desc, depth_desc };
+
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkAttachmentReference.html
         const VkAttachmentReference attachment_ref{
             .attachment = 0,
             .layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
         };
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkAttachmentReference.html
+        const VkAttachmentReference depth_ref{
+            .attachment = 1,
+            .layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+        };
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkSubpassDescription.html
         const VkSubpassDescription subpass_desc{
             .flags = {},
@@ -751,18 +1262,19 @@ namespace cvk
             .colorAttachmentCount = 1,
             .pColorAttachments = &attachment_ref,
             .pResolveAttachments = {},
-            .pDepthStencilAttachment = {},
+            .pDepthStencilAttachment = &depth_ref,
             .preserveAttachmentCount = 0,
             .pPreserveAttachments = {},
         };
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkSubpassDependency.html
+        // Frames in flight share the depth buffer, so its clear must also wait for the previous frame's depth tests.
         const VkSubpassDependency subpass_dep{
             .srcSubpass = VK_SUBPASS_EXTERNAL,
             .dstSubpass = 0,
-            .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-            .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
-            .srcAccessMask = {},
-            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+            .srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+            .srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+            .dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
             .dependencyFlags = {},
         };
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkRenderPassCreateInfo.html
@@ -770,15 +1282,15 @@ namespace cvk
             .sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
             .pNext = {},
             .flags = {},
-            .attachmentCount = 1,
-            .pAttachments = &attachment_desc,
+            .attachmentCount = static_cast<cvk::Offset>(attachment_descs.size()),
+            .pAttachments = attachment_descs.data(),
             .subpassCount = 1,
             .pSubpasses = &subpass_desc,
             .dependencyCount = 1,
             .pDependencies = &subpass_dep,
         };
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateRenderPass.html
-        const VkResult res_pass{ vkCreateRenderPass(gfx.device, &pass_info, ctx.allocator, &gfx.render_pass) };
+        const VkResult res_pass{ vkCreateRenderPass(gfx.device, &pass_info, cvk::allocator(ctx, cvk::HostScope::pipeline), &gfx.render_pass) };
         CGE_ASSERT(res_pass == VK_SUCCESS);
     }
 
@@ -786,7 +1298,7 @@ namespace cvk
     {
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroyRenderPass.html
         if (gfx.render_pass)
-            vkDestroyRenderPass(gfx.device, gfx.render_pass, ctx.allocator);        
+            vkDestroyRenderPass(gfx.device, gfx.render_pass, cvk::allocator(ctx, cvk::HostScope::pipeline));        
     }
 
     static void reinit_layout(cvk::Context& ctx, cvk::Renderable& gfx) noexcept
@@ -812,7 +1324,7 @@ namespace cvk
             .pBindings = descriptor_bindings.data(),
         };
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateDescriptorSetLayout.html
-        const VkResult res_descset_layout{ vkCreateDescriptorSetLayout(gfx.device, &descriptor_layout_info, ctx.allocator, &gfx.descriptor_layout) };
+        const VkResult res_descset_layout{ vkCreateDescriptorSetLayout(gfx.device, &descriptor_layout_info, cvk::allocator(ctx, cvk::HostScope::pipeline), &gfx.descriptor_layout) };
         CGE_ASSERT(res_descset_layout == VK_SUCCESS);
 
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDescriptorPoolSize.html
@@ -831,14 +1343,19 @@ namespace cvk
             .poolSizeCount = static_cast<cvk::Offset>(descriptor_pool_sizes.size()),
             .pPoolSizes = descriptor_pool_sizes.data(),
         };
-        const VkResult res_pool{ vkCreateDescriptorPool(gfx.device, &descriptor_pool_info, ctx.allocator, &gfx.descriptor_pool) };
+        const VkResult res_pool{ vkCreateDescriptorPool(gfx.device, &descriptor_pool_info, cvk::allocator(ctx, cvk::HostScope::pipeline), &gfx.descriptor_pool) };
         CGE_ASSERT(res_pool == VK_SUCCESS);
 
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDescriptorSetLayout.html
         const std::array set_layouts{ gfx.descriptor_layout };
 
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPushConstantRange.html
-        const std::array<VkPushConstantRange, 0> pc_ranges{};
+        const VkPushConstantRange draw_range{
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+            .offset = 0,
+            .size = static_cast<cvk::Offset>(sizeof(cvk::DrawConstants)),
+        };
+        const std::array pc_ranges{ draw_range };
         
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDescriptorSetAllocateInfo.html
         const VkDescriptorSetAllocateInfo alloc_info{
@@ -863,7 +1380,7 @@ namespace cvk
             .pPushConstantRanges = pc_ranges.data(),
         };
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreatePipelineLayout.html
-        const VkResult res_layout{ vkCreatePipelineLayout(gfx.device, &pipeline_layout_info, ctx.allocator, &gfx.pipeline_layout) };
+        const VkResult res_layout{ vkCreatePipelineLayout(gfx.device, &pipeline_layout_info, cvk::allocator(ctx, cvk::HostScope::pipeline), &gfx.pipeline_layout) };
         CGE_ASSERT(res_layout == VK_SUCCESS);
     }
 
@@ -871,15 +1388,15 @@ namespace cvk
     {
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroyDescriptorPool.html
         if (gfx.descriptor_pool)
-            vkDestroyDescriptorPool(gfx.device, gfx.descriptor_pool, ctx.allocator);
+            vkDestroyDescriptorPool(gfx.device, gfx.descriptor_pool, cvk::allocator(ctx, cvk::HostScope::pipeline));
         
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroyDescriptorSetLayout.html
         if (gfx.descriptor_layout)
-            vkDestroyDescriptorSetLayout(gfx.device, gfx.descriptor_layout, ctx.allocator);
+            vkDestroyDescriptorSetLayout(gfx.device, gfx.descriptor_layout, cvk::allocator(ctx, cvk::HostScope::pipeline));
         
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroyPipelineLayout.html
         if (gfx.pipeline_layout)
-            vkDestroyPipelineLayout(gfx.device, gfx.pipeline_layout, ctx.allocator);
+            vkDestroyPipelineLayout(gfx.device, gfx.pipeline_layout, cvk::allocator(ctx, cvk::HostScope::pipeline));
     }
 
     void reinit_pipelines(cvk::Context& ctx [[maybe_unused]], cvk::Renderable& gfx) noexcept
@@ -960,6 +1477,155 @@ namespace cvk
             .vertexAttributeDescriptionCount = static_cast<cvk::Offset>(attributes.size()),
             .pVertexAttributeDescriptions = attributes.data(),
         };
+
+        // ----------------------------------------------------------------
+
+        // Fetching colours as sRGB lets the hardware linearize them, but vertex-buffer support for sRGB formats is optional.
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkFormatProperties.html
+        VkFormatProperties srgb_props{};
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkGetPhysicalDeviceFormatProperties.html
+        vkGetPhysicalDeviceFormatProperties(ctx.devices[gfx.sel_device], VK_FORMAT_B8G8R8A8_SRGB, &srgb_props);
+        const bool fetch_srgb{ (srgb_props.bufferFeatures & VK_FORMAT_FEATURE_VERTEX_BUFFER_BIT) != 0 };
+        const VkBool32 decode_srgb{ fetch_srgb ? VK_FALSE : VK_TRUE };
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkSpecializationMapEntry.html
+        constexpr VkSpecializationMapEntry decode_entry{
+            .constantID = 0,
+            .offset = 0,
+            .size = sizeof(VkBool32),
+        };
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkSpecializationInfo.html
+        const VkSpecializationInfo decode_info{
+            .mapEntryCount = 1,
+            .pMapEntries = &decode_entry,
+            .dataSize = sizeof(decode_srgb),
+            .pData = &decode_srgb,
+        };
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPipelineShaderStageCreateInfo.html
+        const std::array shader_stages_2d{
+            VkPipelineShaderStageCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .pNext = {},
+                .flags = {},
+                .stage = VK_SHADER_STAGE_VERTEX_BIT,
+                .module = gfx.module_vertex_2d,
+                .pName = shader_entry,
+                .pSpecializationInfo = &decode_info,
+            },
+            shader_stages[1],
+        };
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkVertexInputBindingDescription.html
+        constexpr VkVertexInputBindingDescription binding_vertex_2d{
+            .binding = 0,
+            .stride = static_cast<cvk::Offset>(sizeof(cge::Vertex2D)),
+            .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
+        };
+        constexpr std::array bindings_2d{ binding_vertex_2d };
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkVertexInputAttributeDescription.html
+        constexpr VkVertexInputAttributeDescription attribute_xy{
+            .location = 0,
+            .binding = binding_vertex_2d.binding,
+            .format = VK_FORMAT_R32G32_SFLOAT,
+            .offset = offsetof(cge::Vertex2D, xy),
+        };
+        constexpr VkVertexInputAttributeDescription attribute_uv16{
+            .location = 1,
+            .binding = binding_vertex_2d.binding,
+            .format = VK_FORMAT_R16G16_UNORM,
+            .offset = offsetof(cge::Vertex2D, u),
+        };
+        const VkVertexInputAttributeDescription attribute_rgba{
+            .location = 2,
+            .binding = binding_vertex_2d.binding,
+            .format = fetch_srgb ? VK_FORMAT_B8G8R8A8_SRGB : VK_FORMAT_B8G8R8A8_UNORM,
+            .offset = offsetof(cge::Vertex2D, rgba),
+        };
+        const std::array attributes_2d{ attribute_xy, attribute_uv16, attribute_rgba };
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPipelineVertexInputStateCreateInfo.html
+        const VkPipelineVertexInputStateCreateInfo vertex_info_2d{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+            .pNext = {},
+            .flags = {},
+            .vertexBindingDescriptionCount = static_cast<cvk::Offset>(bindings_2d.size()),
+            .pVertexBindingDescriptions = bindings_2d.data(),
+            .vertexAttributeDescriptionCount = static_cast<cvk::Offset>(attributes_2d.size()),
+            .pVertexAttributeDescriptions = attributes_2d.data(),
+        };
+
+        // ----------------------------------------------------------------
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPipelineShaderStageCreateInfo.html
+        const std::array shader_stages_sprite{
+            VkPipelineShaderStageCreateInfo{
+                .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+                .pNext = {},
+                .flags = {},
+                .stage = VK_SHADER_STAGE_VERTEX_BIT,
+                .module = gfx.module_vertex_sprite,
+                .pName = shader_entry,
+                .pSpecializationInfo = &decode_info,
+            },
+            shader_stages[1],
+        };
+
+        // Every attribute advances per instance. The quad's corners come from `gl_VertexIndex`.
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkVertexInputBindingDescription.html
+        constexpr VkVertexInputBindingDescription binding_sprite{
+            .binding = 0,
+            .stride = static_cast<cvk::Offset>(sizeof(cge::Sprite)),
+            .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE,
+        };
+        constexpr std::array bindings_sprite{ binding_sprite };
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkVertexInputAttributeDescription.html
+        constexpr VkVertexInputAttributeDescription attribute_sprite_xy{
+            .location = 0,
+            .binding = binding_sprite.binding,
+            .format = VK_FORMAT_R32G32_SFLOAT,
+            .offset = offsetof(cge::Sprite, xy),
+        };
+        constexpr VkVertexInputAttributeDescription attribute_sprite_scale{
+            .location = 1,
+            .binding = binding_sprite.binding,
+            .format = VK_FORMAT_R32G32_SFLOAT,
+            .offset = offsetof(cge::Sprite, scale),
+        };
+        constexpr VkVertexInputAttributeDescription attribute_sprite_rotation{
+            .location = 2,
+            .binding = binding_sprite.binding,
+            .format = VK_FORMAT_R32_SFLOAT,
+            .offset = offsetof(cge::Sprite, rotation),
+        };
+        constexpr VkVertexInputAttributeDescription attribute_sprite_uv{
+            .location = 3,
+            .binding = binding_sprite.binding,
+            .format = VK_FORMAT_R16G16B16A16_UNORM,
+            .offset = offsetof(cge::Sprite, u0),
+        };
+        const VkVertexInputAttributeDescription attribute_sprite_rgba{
+            .location = 4,
+            .binding = binding_sprite.binding,
+            .format = fetch_srgb ? VK_FORMAT_B8G8R8A8_SRGB : VK_FORMAT_B8G8R8A8_UNORM,
+            .offset = offsetof(cge::Sprite, rgba),
+        };
+        const std::array attributes_sprite{ attribute_sprite_xy, attribute_sprite_scale, attribute_sprite_rotation, attribute_sprite_uv, attribute_sprite_rgba };
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPipelineVertexInputStateCreateInfo.html
+        const VkPipelineVertexInputStateCreateInfo vertex_info_sprite{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+            .pNext = {},
+            .flags = {},
+            .vertexBindingDescriptionCount = static_cast<cvk::Offset>(bindings_sprite.size()),
+            .pVertexBindingDescriptions = bindings_sprite.data(),
+            .vertexAttributeDescriptionCount = static_cast<cvk::Offset>(attributes_sprite.size()),
+            .pVertexAttributeDescriptions = attributes_sprite.data(),
+        };
+
+        // ----------------------------------------------------------------
         
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkViewport.html
         const VkViewport viewport{
@@ -1044,6 +1710,23 @@ namespace cvk
             .blendConstants = { 0.0f, 0.0f, 0.0f, 0.0f },
         };
 
+        // Blended geometry is hidden behind opaque geometry, but does not hide anything itself.
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPipelineDepthStencilStateCreateInfo.html
+        const VkPipelineDepthStencilStateCreateInfo depth_info{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+            .pNext = {},
+            .flags = {},
+            .depthTestEnable = VK_TRUE,
+            .depthWriteEnable = VK_FALSE,
+            .depthCompareOp = VK_COMPARE_OP_LESS_OR_EQUAL,
+            .depthBoundsTestEnable = VK_FALSE,
+            .stencilTestEnable = VK_FALSE,
+            .front = {},
+            .back = {},
+            .minDepthBounds = 0.0f,
+            .maxDepthBounds = 1.0f,
+        };
+
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkGraphicsPipelineCreateInfo.html
         const VkGraphicsPipelineCreateInfo default_pipeline{
             .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
@@ -1057,7 +1740,7 @@ namespace cvk
             .pViewportState = &viewport_info,
             .pRasterizationState = &rasterizer_info,
             .pMultisampleState = &multisample_info,
-            .pDepthStencilState = {},
+            .pDepthStencilState = &depth_info,
             .pColorBlendState = &blend_info,
             .pDynamicState = &dynamic_info,
             .layout = gfx.pipeline_layout,
@@ -1078,13 +1761,52 @@ namespace cvk
 
         VkGraphicsPipelineCreateInfo pipeline_triangle_list{ default_pipeline };
         pipeline_triangle_list.pInputAssemblyState = &assembly_triangle_list;
+
+        VkGraphicsPipelineCreateInfo pipeline_triangle_list_2d{ pipeline_triangle_list };
+        pipeline_triangle_list_2d.stageCount = static_cast<cvk::Offset>(shader_stages_2d.size());
+        pipeline_triangle_list_2d.pStages = shader_stages_2d.data();
+        pipeline_triangle_list_2d.pVertexInputState = &vertex_info_2d;
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPipelineInputAssemblyStateCreateInfo.html
+        constexpr VkPipelineInputAssemblyStateCreateInfo assembly_triangle_strip{
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+            .pNext = {},
+            .flags = {},
+            .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP,
+            .primitiveRestartEnable = VK_FALSE,
+        };
+
+        VkGraphicsPipelineCreateInfo pipeline_sprite_strip{ default_pipeline };
+        pipeline_sprite_strip.stageCount = static_cast<cvk::Offset>(shader_stages_sprite.size());
+        pipeline_sprite_strip.pStages = shader_stages_sprite.data();
+        pipeline_sprite_strip.pVertexInputState = &vertex_info_sprite;
+        pipeline_sprite_strip.pInputAssemblyState = &assembly_triangle_strip;
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPipelineColorBlendAttachmentState.html
+        VkPipelineColorBlendAttachmentState blend_attachment_opaque{ blend_attachment };
+        blend_attachment_opaque.blendEnable = VK_FALSE;
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPipelineColorBlendStateCreateInfo.html
+        VkPipelineColorBlendStateCreateInfo blend_info_opaque{ blend_info };
+        blend_info_opaque.pAttachments = &blend_attachment_opaque;
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPipelineDepthStencilStateCreateInfo.html
+        VkPipelineDepthStencilStateCreateInfo depth_info_opaque{ depth_info };
+        depth_info_opaque.depthWriteEnable = VK_TRUE;
+
+        VkGraphicsPipelineCreateInfo pipeline_triangle_list_opaque{ pipeline_triangle_list };
+        pipeline_triangle_list_opaque.pDepthStencilState = &depth_info_opaque;
+        pipeline_triangle_list_opaque.pColorBlendState = &blend_info_opaque;
         
-        const std::array<VkGraphicsPipelineCreateInfo, cvk::num_pipelines> pipeline_infos{
+        const std::array<VkGraphicsPipelineCreateInfo, cvk::num_graphics_pipelines> pipeline_infos{
             pipeline_triangle_list,
+            pipeline_triangle_list_2d,
+            pipeline_sprite_strip,
+            pipeline_triangle_list_opaque,
         };
 
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateGraphicsPipelines.html
-        const VkResult res_graphics{ vkCreateGraphicsPipelines(gfx.device, nullptr, static_cast<cvk::Offset>(pipeline_infos.size()), pipeline_infos.data(), ctx.allocator, gfx.pipelines_graphics) };
+        const VkResult res_graphics{ vkCreateGraphicsPipelines(gfx.device, nullptr, static_cast<cvk::Offset>(pipeline_infos.size()), pipeline_infos.data(), cvk::allocator(ctx, cvk::HostScope::pipeline), gfx.pipelines_graphics) };
         CGE_ASSERT(res_graphics == VK_SUCCESS);
     }
 
@@ -1094,7 +1816,7 @@ namespace cvk
         for (const VkPipeline pipeline : gfx.pipelines_graphics)
         {
             if (pipeline)
-                vkDestroyPipeline(gfx.device, pipeline, ctx.allocator);
+                vkDestroyPipeline(gfx.device, pipeline, cvk::allocator(ctx, cvk::HostScope::pipeline));
         }
     }
 
@@ -1103,6 +1825,10 @@ namespace cvk
         cvk::update_surface_info(ctx, gfx, gfx.sel_device, vsync);
         if (!(gfx.surface_extent.width && gfx.surface_extent.height)) return;
 
+    #if defined(CGE_DEBUG)
+        const cvk::HostCounters host_before{ cvk::host_counters(ctx, cvk::HostScope::swapchain) };
+    #endif
+
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkSurfaceCapabilitiesKHR.html#_description
         const cvk::Offset min_images{ gfx.ds_capabilities.surfaceCapabilities.minImageCount };
         const cvk::Offset max_images{ gfx.ds_capabilities.surfaceCapabilities.maxImageCount };
@@ -1139,7 +1865,7 @@ namespace cvk
             };
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateSwapchainKHR.html
             VkSwapchainKHR new_swapchain;
-            const VkResult res_swapchain{ vkCreateSwapchainKHR(gfx.device, &swapchain_info, ctx.allocator, &new_swapchain) };
+            const VkResult res_swapchain{ vkCreateSwapchainKHR(gfx.device, &swapchain_info, cvk::allocator(ctx, cvk::HostScope::swapchain), &new_swapchain) };
             CGE_ASSERT(res_swapchain == VK_SUCCESS);
 
             if (gfx.swapchain != VK_NULL_HANDLE)
@@ -1149,6 +1875,10 @@ namespace cvk
                 (void)res_wait;
 
                 cvk::deinit_swapchain(ctx, gfx, false);
+
+                // The device is idle, so a retired upload buffer no longer has readers.
+                cvk::destroy_buffer(ctx, gfx, gfx.buffer_retired, gfx.buffer_retired_memory, gfx.buffer_retired_mapped);
+                gfx.buffer_retired_frames = {};
             }
             gfx.swapchain = new_swapchain;
         }
@@ -1169,7 +1899,12 @@ namespace cvk
                         gfx.frame_commands,
                         gfx.frame_fence,
                         gfx.frame_sem_render,
-                        gfx.frame_sem_image
+                        gfx.frame_sem_image,
+                        gfx.frame_overflow,
+                        gfx.frame_overflow_memory,
+                        gfx.frame_overflow_mapped,
+                        gfx.frame_overflow_capacity,
+                        gfx.frame_command_key
                     )
                 };
                 CGE_ASSERT(res_resize);
@@ -1177,8 +1912,28 @@ namespace cvk
                 CGE_ASSERT(res_images == VK_SUCCESS);
             }
 
+            if (gfx.buffer_main && (gfx.buffer_region * gfx.frame_count > gfx.buffer_capacity))
+            {
+                // The upload ring needs one region per frame-in-flight.
+
+                // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDeviceWaitIdle.html
+                const VkResult res_wait{ vkDeviceWaitIdle(gfx.device) };
+                (void)res_wait;
+
+                cvk::deinit_buffers(ctx, gfx);
+                cvk::reinit_buffers(ctx, gfx);
+            }
+
+            cvk::reinit_depth(ctx, gfx);
+
             for (cvk::Offset idx{}; idx < gfx.frame_count; ++idx)
             {
+                gfx.frame_overflow[idx] = {};
+                gfx.frame_overflow_memory[idx] = {};
+                gfx.frame_overflow_mapped[idx] = {};
+                gfx.frame_overflow_capacity[idx] = {};
+                gfx.frame_command_key[idx] = {};
+
                 // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkFenceCreateInfo.html
                 constexpr VkFenceCreateInfo fence_info{
                     .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
@@ -1192,12 +1947,12 @@ namespace cvk
                     .flags = {},
                 };
                 // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateFence.html
-                const VkResult res_fence{ vkCreateFence(gfx.device, &fence_info, ctx.allocator, &gfx.frame_fence[idx]) };
+                const VkResult res_fence{ vkCreateFence(gfx.device, &fence_info, cvk::allocator(ctx, cvk::HostScope::swapchain), &gfx.frame_fence[idx]) };
                 CGE_ASSERT(res_fence == VK_SUCCESS);
                 // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateSemaphore.html
-                const VkResult res_sem_render{ vkCreateSemaphore(gfx.device, &sem_info, ctx.allocator, &gfx.frame_sem_render[idx]) };
+                const VkResult res_sem_render{ vkCreateSemaphore(gfx.device, &sem_info, cvk::allocator(ctx, cvk::HostScope::swapchain), &gfx.frame_sem_render[idx]) };
                 CGE_ASSERT(res_sem_render == VK_SUCCESS);
-                const VkResult res_sem_image{ vkCreateSemaphore(gfx.device, &sem_info, ctx.allocator, &gfx.frame_sem_image[idx]) };
+                const VkResult res_sem_image{ vkCreateSemaphore(gfx.device, &sem_info, cvk::allocator(ctx, cvk::HostScope::swapchain), &gfx.frame_sem_image[idx]) };
                 CGE_ASSERT(res_sem_image == VK_SUCCESS);
 
                 // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkImageViewCreateInfo.html
@@ -1218,23 +1973,25 @@ namespace cvk
                     },
                 };
                 // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateImageView.html
-                const VkResult res_view{ vkCreateImageView(gfx.device, &view_info, ctx.allocator, &gfx.frame_view[idx]) };
+                const VkResult res_view{ vkCreateImageView(gfx.device, &view_info, cvk::allocator(ctx, cvk::HostScope::swapchain), &gfx.frame_view[idx]) };
                 CGE_ASSERT(res_view == VK_SUCCESS);
 
+                const std::array frame_attachments{ gfx.frame_view[idx], gfx.depth_view };
+
                 // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkFramebufferCreateInfo.html
                 const VkFramebufferCreateInfo buffer_info{
                     .sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
                     .pNext = {},
                     .flags = {},
                     .renderPass = gfx.render_pass,
-                    .attachmentCount = 1,
-                    .pAttachments = &gfx.frame_view[idx],
+                    .attachmentCount = static_cast<cvk::Offset>(frame_attachments.size()),
+                    .pAttachments = frame_attachments.data(),
                     .width = gfx.surface_extent.width,
                     .height = gfx.surface_extent.height,
                     .layers = 1,
                 };
                 // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateFramebuffer.html
-                const VkResult res_buffer{ vkCreateFramebuffer(gfx.device, &buffer_info, ctx.allocator, &gfx.frame_buffer[idx]) };
+                const VkResult res_buffer{ vkCreateFramebuffer(gfx.device, &buffer_info, cvk::allocator(ctx, cvk::HostScope::swapchain), &gfx.frame_buffer[idx]) };
                 CGE_ASSERT(res_buffer == VK_SUCCESS);
             }
 
@@ -1250,6 +2007,14 @@ namespace cvk
             const VkResult res_alloc{ vkAllocateCommandBuffers(gfx.device, &alloc_info, gfx.frame_commands) };
             CGE_ASSERT(res_alloc == VK_SUCCESS);
         }
+
+    #if defined(CGE_DEBUG)
+        const cvk::HostCounters host_after{ cvk::host_counters(ctx, cvk::HostScope::swapchain) };
+        CGE_LOG("[CGE] Swapchain host memory: {} allocs, {} frees, {} -> {} bytes (peak {})\n",
+            host_after.allocations - host_before.allocations, host_after.frees - host_before.frees,
+            host_before.current, host_after.current, host_after.peak
+        );
+    #endif
     }
 
     void deinit_swapchain(cvk::Context& ctx [[maybe_unused]], cvk::Renderable& gfx, const bool deallocate) noexcept
@@ -1260,32 +2025,114 @@ namespace cvk
         
         for (cvk::Offset idx{}; idx < gfx.frame_count; ++idx)
         {
+            cvk::destroy_buffer(ctx, gfx, gfx.frame_overflow[idx], gfx.frame_overflow_memory[idx], gfx.frame_overflow_mapped[idx]);
+            gfx.frame_overflow_capacity[idx] = {};
+
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroyFramebuffer.html
             if (gfx.frame_buffer[idx])
-                vkDestroyFramebuffer(gfx.device, gfx.frame_buffer[idx], ctx.allocator);
+                vkDestroyFramebuffer(gfx.device, gfx.frame_buffer[idx], cvk::allocator(ctx, cvk::HostScope::swapchain));
             
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroyImageView.html
             if (gfx.frame_view[idx])
-                vkDestroyImageView(gfx.device, gfx.frame_view[idx], ctx.allocator);
+                vkDestroyImageView(gfx.device, gfx.frame_view[idx], cvk::allocator(ctx, cvk::HostScope::swapchain));
             
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroySemaphore.html
             if (gfx.frame_sem_image[idx])
-                vkDestroySemaphore(gfx.device, gfx.frame_sem_image[idx], ctx.allocator);
+                vkDestroySemaphore(gfx.device, gfx.frame_sem_image[idx], cvk::allocator(ctx, cvk::HostScope::swapchain));
             
             if (gfx.frame_sem_render[idx])
-                vkDestroySemaphore(gfx.device, gfx.frame_sem_render[idx], ctx.allocator);
+                vkDestroySemaphore(gfx.device, gfx.frame_sem_render[idx], cvk::allocator(ctx, cvk::HostScope::swapchain));
             
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroyFence.html
             if (gfx.frame_fence[idx])
-                vkDestroyFence(gfx.device, gfx.frame_fence[idx], ctx.allocator);
+                vkDestroyFence(gfx.device, gfx.frame_fence[idx], cvk::allocator(ctx, cvk::HostScope::swapchain));
         }
 
+        cvk::deinit_depth(ctx, gfx);
+
         if (deallocate)
             soa::dealloc(gfx.frame_count, gfx.frame_image);
         
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroySwapchainKHR.html
         if (gfx.swapchain)
-            vkDestroySwapchainKHR(gfx.device, gfx.swapchain, ctx.allocator);
+            vkDestroySwapchainKHR(gfx.device, gfx.swapchain, cvk::allocator(ctx, cvk::HostScope::swapchain));
+    }
+
+    void reinit_depth(cvk::Context& ctx, cvk::Renderable& gfx) noexcept
+    {
+        {
+            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkImageCreateInfo.html
+            const VkImageCreateInfo image_info{
+                .sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+                .pNext = {},
+                .flags = {},
+                .imageType = VK_IMAGE_TYPE_2D,
+                .format = gfx.depth_format,
+                .extent = { .width = gfx.surface_extent.width, .height = gfx.surface_extent.height, .depth = 1 },
+                .mipLevels = 1,
+                .arrayLayers = 1,
+                .samples = VK_SAMPLE_COUNT_1_BIT,
+                .tiling = VK_IMAGE_TILING_OPTIMAL,
+                .usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                .sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+                .queueFamilyIndexCount = {},
+                .pQueueFamilyIndices = {},
+                .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+            };
+            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateImage.html
+            const VkResult res_image{ vkCreateImage(gfx.device, &image_info, cvk::allocator(ctx, cvk::HostScope::resource), &gfx.depth_image) };
+            CGE_ASSERT(res_image == VK_SUCCESS);
+        }
+        {
+            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkGetImageMemoryRequirements.html
+            VkMemoryRequirements memreqs;
+            vkGetImageMemoryRequirements(gfx.device, gfx.depth_image, &memreqs);
+
+            const VkResult res_alloc{ cvk::allocate_memory(ctx, gfx, memreqs, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, cvk::Strategy::tlsf, gfx.depth_memory) };
+            CGE_ASSERT(res_alloc == VK_SUCCESS);
+
+            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkBindImageMemory.html
+            const VkResult res_bind{ vkBindImageMemory(gfx.device, gfx.depth_image, gfx.depth_memory.memory, gfx.depth_memory.offset) };
+            CGE_ASSERT(res_bind == VK_SUCCESS);
+        }
+        {
+            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkImageViewCreateInfo.html
+            const VkImageViewCreateInfo view_info{
+                .sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+                .pNext = {},
+                .flags = {},
+                .image = gfx.depth_image,
+                .viewType = VK_IMAGE_VIEW_TYPE_2D,
+                .format = gfx.depth_format,
+                .components = {},
+                .subresourceRange = {
+                    .aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
+                    .baseMipLevel = 0,
+                    .levelCount = 1,
+                    .baseArrayLayer = 0,
+                    .layerCount = 1,
+                },
+            };
+            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateImageView.html
+            const VkResult res_view{ vkCreateImageView(gfx.device, &view_info, cvk::allocator(ctx, cvk::HostScope::resource), &gfx.depth_view) };
+            CGE_ASSERT(res_view == VK_SUCCESS);
+        }
+    }
+
+    void deinit_depth(cvk::Context& ctx [[maybe_unused]], cvk::Renderable& gfx) noexcept
+    {
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroyImageView.html
+        if (gfx.depth_view)
+            vkDestroyImageView(gfx.device, gfx.depth_view, cvk::allocator(ctx, cvk::HostScope::resource));
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroyImage.html
+        if (gfx.depth_image)
+            vkDestroyImage(gfx.device, gfx.depth_image, cvk::allocator(ctx, cvk::HostScope::resource));
+
+        cvk::free_memory(ctx, gfx, gfx.depth_memory);
+
+        gfx.depth_view = {};
+        gfx.depth_image = {};
     }
 }
 
@@ -1346,21 +2193,21 @@ namespace cvk
 
     void destroy_atlas(cvk::Context& ctx [[maybe_unused]], cvk::Renderable& gfx, const cvk::Offset atlas_idx) noexcept
     {
+        ++gfx.command_epoch;
+
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroySampler.html
         if (gfx.atlas_sampler[atlas_idx])
-            vkDestroySampler(gfx.device, gfx.atlas_sampler[atlas_idx], ctx.allocator);
+            vkDestroySampler(gfx.device, gfx.atlas_sampler[atlas_idx], cvk::allocator(ctx, cvk::HostScope::resource));
 
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroyImageView.html
         if (gfx.atlas_view[atlas_idx])
-            vkDestroyImageView(gfx.device, gfx.atlas_view[atlas_idx], ctx.allocator);
+            vkDestroyImageView(gfx.device, gfx.atlas_view[atlas_idx], cvk::allocator(ctx, cvk::HostScope::resource));
 
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkDestroyImage.html
         if (gfx.atlas_image[atlas_idx])
-            vkDestroyImage(gfx.device, gfx.atlas_image[atlas_idx], ctx.allocator);
+            vkDestroyImage(gfx.device, gfx.atlas_image[atlas_idx], cvk::allocator(ctx, cvk::HostScope::resource));
 
-        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkFreeMemory.html
-        if (gfx.atlas_memory[atlas_idx])
-            vkFreeMemory(gfx.device, gfx.atlas_memory[atlas_idx], ctx.allocator);
+        cvk::free_memory(ctx, gfx, gfx.atlas_memory[atlas_idx]);
     }
 
     void upload_texture(cvk::Context& ctx, cvk::Renderable& gfx, const cvk::Offset atlas_idx, cge::Texture texture) noexcept
@@ -1413,31 +2260,18 @@ namespace cvk
                 .initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
             };
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateImage.html
-            const VkResult res_image{ vkCreateImage(gfx.device, &image_info, ctx.allocator, &gfx.atlas_image[atlas_idx]) };
+            const VkResult res_image{ vkCreateImage(gfx.device, &image_info, cvk::allocator(ctx, cvk::HostScope::resource), &gfx.atlas_image[atlas_idx]) };
             CGE_ASSERT(res_image == VK_SUCCESS);
 
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkGetImageMemoryRequirements.html
             vkGetImageMemoryRequirements(gfx.device, gfx.atlas_image[atlas_idx], &gfx.atlas_memreqs[atlas_idx]);
         }
         {
-            const VkPhysicalDeviceMemoryProperties& mem_props{ ctx.device_memory[gfx.sel_device] };
-            const std::span<const VkMemoryType> mem_types{ mem_props.memoryTypes, mem_props.memoryTypeCount };
-            const cvk::Offset mem_idx{ cvk::find_memtype(mem_types, gfx.atlas_memreqs[atlas_idx].memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) };
-            CGE_ASSERT(mem_idx != null_idx);
-
-            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkMemoryAllocateInfo.html
-            const VkMemoryAllocateInfo alloc_info{
-                .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-                .pNext = {},
-                .allocationSize = gfx.atlas_memreqs[atlas_idx].size,
-                .memoryTypeIndex = mem_idx,
-            };
-            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkAllocateMemory.html
-            const VkResult res_alloc{ vkAllocateMemory(gfx.device, &alloc_info, ctx.allocator, &gfx.atlas_memory[atlas_idx]) };
+            const VkResult res_alloc{ cvk::allocate_memory(ctx, gfx, gfx.atlas_memreqs[atlas_idx], VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, cvk::Strategy::tlsf, gfx.atlas_memory[atlas_idx]) };
             CGE_ASSERT(res_alloc == VK_SUCCESS);
 
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkBindImageMemory.html
-            const VkResult res_bind{ vkBindImageMemory(gfx.device, gfx.atlas_image[atlas_idx], gfx.atlas_memory[atlas_idx], 0) };
+            const VkResult res_bind{ vkBindImageMemory(gfx.device, gfx.atlas_image[atlas_idx], gfx.atlas_memory[atlas_idx].memory, gfx.atlas_memory[atlas_idx].offset) };
             CGE_ASSERT(res_bind == VK_SUCCESS);
         }        
         {
@@ -1459,7 +2293,7 @@ namespace cvk
                 },
             };
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateImageView.html
-            const VkResult res_view{ vkCreateImageView(gfx.device, &view_info, ctx.allocator, &gfx.atlas_view[atlas_idx]) };
+            const VkResult res_view{ vkCreateImageView(gfx.device, &view_info, cvk::allocator(ctx, cvk::HostScope::resource), &gfx.atlas_view[atlas_idx]) };
             CGE_ASSERT(res_view == VK_SUCCESS);
         }
         {
@@ -1485,7 +2319,7 @@ namespace cvk
                 .unnormalizedCoordinates = VK_FALSE,
             };
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateSampler.html
-            const VkResult res_sampler{ vkCreateSampler(gfx.device, &sampler_info, ctx.allocator, &gfx.atlas_sampler[atlas_idx]) };
+            const VkResult res_sampler{ vkCreateSampler(gfx.device, &sampler_info, cvk::allocator(ctx, cvk::HostScope::resource), &gfx.atlas_sampler[atlas_idx]) };
             CGE_ASSERT(res_sampler == VK_SUCCESS);
         }
     }
@@ -1533,10 +2367,11 @@ namespace cvk
             },
         };
 
-        cvk::single_commands(ctx, gfx, [&](const VkCommandBuffer command_buffer){
+        const VkResult res_commands{ cvk::single_commands(ctx, gfx, gfx.command_pool, gfx.queue_graphics, [&](const VkCommandBuffer command_buffer){
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdPipelineBarrier.html
             vkCmdPipelineBarrier(command_buffer, src_stage, dst_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-        });
+        }) };
+        CGE_ASSERT(res_commands == VK_SUCCESS);
     }
 
     void stage_texture(cvk::Context& ctx, cvk::Renderable& gfx, const cvk::Offset atlas_idx, const cge::Texture tex) noexcept
@@ -1545,22 +2380,15 @@ namespace cvk
             const VkDeviceSize tex_size{ static_cast<VkDeviceSize>(tex.size()) };
             CGE_ASSERT(tex_size <= gfx.buffer_capacity);
 
-            const VkDeviceMemory buffer_memory{ gfx.buffer_memory };
-            const VkDeviceSize buffer_offs{ 0 };
             const VkDeviceSize buffer_size{ gfx.buffer_capacity };
+            void* const buffer{ gfx.buffer_mapped };
             {
-                void* buffer{};
-
-                // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkMapMemory.html
-                const VkResult res_map{ vkMapMemory(gfx.device, buffer_memory, buffer_offs, buffer_size, 0, &buffer) };
-                CGE_ASSERT(res_map == VK_SUCCESS);
-
                 VkDeviceSize offset{};
                 (void)cvk::map_bytes(buffer_size, buffer, offset, tex.as_bytes());
-
-                // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkUnmapMemory.html
-                vkUnmapMemory(gfx.device, buffer_memory);
             }
+
+            const VkResult res_flush{ cvk::flush_memory(ctx, gfx, gfx.buffer_memory, 0, tex_size) };
+            CGE_ASSERT(res_flush == VK_SUCCESS);
         }
         {
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkBufferImageCopy.html
@@ -1582,15 +2410,19 @@ namespace cvk
                 },
             };
 
-            cvk::single_commands(ctx, gfx, [&](const VkCommandBuffer command_buffer){
+            const VkResult res_commands{ cvk::single_commands(ctx, gfx, gfx.command_pool, gfx.queue_graphics, [&](const VkCommandBuffer command_buffer){
                 // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdCopyBufferToImage.html
                 vkCmdCopyBufferToImage(command_buffer, gfx.buffer_main, gfx.atlas_image[atlas_idx], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-            });
+            }) };
+            CGE_ASSERT(res_commands == VK_SUCCESS);
         }
     }
 
     void update_descriptors(cvk::Context& ctx [[maybe_unused]], cvk::Renderable& gfx, cvk::Offset atlas_idx) noexcept
     {
+        // Rewriting a bound descriptor set invalidates the command buffers it was recorded into.
+        ++gfx.command_epoch;
+
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDescriptorImageInfo.html
         const VkDescriptorImageInfo image_info{
             .sampler = gfx.atlas_sampler[atlas_idx],
@@ -1619,10 +2451,8 @@ namespace cvk
         vkUpdateDescriptorSets(gfx.device, static_cast<cvk::Offset>(writes.size()), writes.data(), static_cast<cvk::Offset>(copies.size()), copies.data());
     }
 
-    void single_commands(cvk::Context& ctx [[maybe_unused]], cvk::Renderable& gfx, auto&& callback) noexcept
+    VkResult single_commands(cvk::Context& ctx [[maybe_unused]], cvk::Renderable& gfx, const VkCommandPool command_pool, const VkQueue queue, auto&& callback) noexcept
     {
-        const VkCommandPool command_pool{ gfx.command_pool };
-        const VkQueue queue{ gfx.queue_graphics };
         VkCommandBuffer command_buffer{};
 
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkCommandBufferAllocateInfo.html
@@ -1635,7 +2465,7 @@ namespace cvk
         };
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkAllocateCommandBuffers.html
         const VkResult res_alloc{ vkAllocateCommandBuffers(gfx.device, &alloc_info, &command_buffer) };
-        CGE_ASSERT(res_alloc == VK_SUCCESS);
+        if (res_alloc != VK_SUCCESS) return res_alloc;
         
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkCommandBufferBeginInfo.html
         const VkCommandBufferBeginInfo begin_info{
@@ -1667,14 +2497,14 @@ namespace cvk
 
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkQueueSubmit.html
         const VkResult res_submit{ vkQueueSubmit(queue, 1, &submit_info, nullptr) };
-        CGE_ASSERT(res_submit == VK_SUCCESS);
 
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkQueueWaitIdle.html
-        const VkResult res_wait{ vkQueueWaitIdle(queue) };
-        CGE_ASSERT(res_wait == VK_SUCCESS);
+        const VkResult res_wait{ (res_submit == VK_SUCCESS) ? vkQueueWaitIdle(queue) : res_submit };
 
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkFreeCommandBuffers.html
         vkFreeCommandBuffers(gfx.device, command_pool, 1, &command_buffer);
+
+        return res_wait;
     }
 }
 
@@ -1685,9 +2515,11 @@ namespace cvk
         cvk::Offset device_idx{};
         cvk::Offset graphics_idx{};
         cvk::Offset present_idx{};
+        cvk::Offset transfer_idx{};
         std::uint64_t device_rank{};
         std::uint64_t graphics_rank{};
         std::uint64_t present_rank{};
+        std::uint64_t transfer_rank{};
 
         const cvk::Offset device_count{ ctx.device_count };
         for (cvk::Offset di{}; di < device_count; ++di)
@@ -1712,6 +2544,8 @@ namespace cvk
                 graphics_rank = 0;
                 present_idx = 0;
                 present_rank = 0;
+                transfer_idx = 0;
+                transfer_rank = 0;
 
                 const cvk::Offset fam_count{ ctx.device_fam_count[di] };
                 for (cvk::Offset qfi{}; qfi < fam_count; ++qfi)
@@ -1729,6 +2563,13 @@ namespace cvk
                         present_idx = qfi;
                         present_rank = rank_g;
                     }
+
+                    const std::uint64_t rank_t{ cvk::rank_device_transfer(ctx, gfx, di, qfi) };
+                    if (rank_t > transfer_rank)
+                    {
+                        transfer_idx = qfi;
+                        transfer_rank = rank_t;
+                    }
                 }
             }
         }
@@ -1736,11 +2577,13 @@ namespace cvk
         gfx.sel_device = device_idx;
         gfx.sel_graphics = graphics_idx;
         gfx.sel_present = present_idx;
+        gfx.sel_transfer = (transfer_rank > 0) ? transfer_idx : graphics_idx;
 
         #if defined(CGE_DEBUG)
         {
             const VkPhysicalDeviceProperties& props{ ctx.device_properties[gfx.sel_device] };
             CGE_LOG("[CGE] Selected: \"{}\"\n", props.deviceName);
+            CGE_LOG("[CGE] Queues: graphics {}, present {}, transfer {}\n", gfx.sel_graphics, gfx.sel_present, gfx.sel_transfer);
         }
         #endif
     }
@@ -1812,6 +2655,25 @@ namespace cvk
 
         return rank;
     }
+
+    cvk::Ranking rank_device_transfer(const cvk::Context& ctx, const cvk::Renderable& gfx [[maybe_unused]], const cvk::Offset device_idx, const cvk::Offset queue_idx) noexcept
+    {
+        const VkQueueFamilyProperties& qf_props{ ctx.device_fam_array[device_idx][queue_idx] };
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkQueueFlagBits.html#_description
+        constexpr VkQueueFlags transfer_capable{ VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT | VK_QUEUE_TRANSFER_BIT };
+        if ((qf_props.queueFlags & transfer_capable) == 0) return 0;
+
+        std::uint64_t rank{ 1 };
+
+        // Dedicated transfer families usually map to the DMA engines, which copy without stalling graphics work.
+        if ((qf_props.queueFlags & VK_QUEUE_GRAPHICS_BIT) == 0) rank += 100;
+        if ((qf_props.queueFlags & VK_QUEUE_COMPUTE_BIT) == 0) rank += 100;
+
+        rank += qf_props.queueCount;
+
+        return rank;
+    }
 }
 
 namespace cvk
@@ -1917,7 +2779,7 @@ namespace cvk
             .pCode = code.data(),
         };
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCreateShaderModule.html
-        const VkResult res_module{ vkCreateShaderModule(gfx.device, &module_info, ctx.allocator, &module) };
+        const VkResult res_module{ vkCreateShaderModule(gfx.device, &module_info, cvk::allocator(ctx, cvk::HostScope::pipeline), &module) };
         CGE_ASSERT(res_module == VK_SUCCESS);
     }
 
@@ -1937,19 +2799,39 @@ namespace cvk
         return prev;
     };
 
-    cvk::Offset find_memtype(const std::span<const VkMemoryType> mem_types, const cvk::Offset alloc_type, const cvk::Offset alloc_props) noexcept
+    VkDeviceSize map_indices16(const VkDeviceSize buffer_size, void* const buffer, VkDeviceSize& offs, const std::span<const cge::Index> indices) noexcept
     {
-        for (cvk::Offset idx{}; idx < static_cast<cvk::Offset>(mem_types.size()); ++idx)
-        {
-            const VkMemoryType& mem_type{ mem_types[idx] };
-            
-            const cvk::Offset this_bit{ static_cast<cvk::Offset>(1) << idx };
-            const bool has_type{ (this_bit & alloc_type) != 0 };
-            const bool has_props{ (mem_type.propertyFlags & alloc_props) == alloc_props };
+        const VkDeviceSize size{ static_cast<VkDeviceSize>(indices.size() * sizeof(std::uint16_t)) };
+        const VkDeviceSize next{ offs + size };
+        CGE_ASSERT(offs % alignof(std::uint16_t) == 0);
+        CGE_ASSERT(offs <= buffer_size);
+        CGE_ASSERT(size <= buffer_size);
+        CGE_ASSERT(next <= buffer_size);
 
-            if (has_type && has_props) return idx;
-        }
-        return null_idx;
+        std::uint16_t* const dst{ reinterpret_cast<std::uint16_t*>(static_cast<std::byte*>(buffer) + offs) };
+        simd::narrow_u16(dst, indices.data(), indices.size());
+
+        const VkDeviceSize prev{ offs };
+        offs = next;
+        return prev;
+    }
+
+    VkDeviceSize stream_size(const cvk::Stream& stream) noexcept
+    {
+        const VkDeviceSize size{ static_cast<VkDeviceSize>(stream.bytes.size()) };
+        return stream.narrow ? (size / sizeof(cge::Index)) * sizeof(std::uint16_t) : size;
+    }
+
+    bool is_lent(const cvk::Renderable& gfx, const cvk::Offset frame_idx, const std::span<const std::byte> bytes) noexcept
+    {
+        if (!gfx.buffer_mapped || !bytes.data()) return false;
+
+        const std::uintptr_t region_beg{ reinterpret_cast<std::uintptr_t>(gfx.buffer_mapped) + gfx.buffer_region * frame_idx };
+        const std::uintptr_t region_end{ region_beg + gfx.buffer_region };
+        const std::uintptr_t bytes_beg{ reinterpret_cast<std::uintptr_t>(bytes.data()) };
+        const std::uintptr_t bytes_end{ bytes_beg + bytes.size() };
+
+        return (bytes_beg >= region_beg) && (bytes_end <= region_end);
     }
 
     #define CVK_FIND_RETURN(find, range, ...) if (find(__VA_ARGS__) != range.end()) return { __VA_ARGS__ }
@@ -1999,24 +2881,45 @@ namespace cvk
 
 namespace cvk
 {
-    VkResult render_frame(cvk::Context& ctx [[maybe_unused]], cvk::Renderable& gfx, const cge::Scene& scene) noexcept
+    VkResult render_frame(cvk::Context& ctx, cvk::Renderable& gfx, const cge::Scene& scene) noexcept
     {
         const cvk::Offset this_frame{ gfx.frame_idx };
-        const cvk::Offset prev_frame{ (this_frame + (gfx.frame_count - 1)) % gfx.frame_count };
 
         const VkSemaphore image_acquired{ gfx.frame_sem_image[this_frame] };
         const VkSemaphore render_finished{ gfx.frame_sem_render[this_frame] };
         const VkFence this_available{ gfx.frame_fence[this_frame] };
-        const VkFence prev_available{ gfx.frame_fence[prev_frame] };
 
+        // Each frame uploads into its own region of `buffer_main`, so only this frame's previous submission must be finished.
         cvk::Offset image_idx;
-        const VkResult res_acquire{ cvk::acquire_image(gfx, image_idx, image_acquired, std::array{ this_available, prev_available }, std::array{ this_available }) };
+        const VkResult res_acquire{ cvk::acquire_image(gfx, image_idx, image_acquired, std::array{ this_available }, std::array{ this_available }) };
         if (res_acquire < VK_SUCCESS)
         {
             // CGE_LOG("[CGE] Render failed. (Could not acquire image)\n");
             return res_acquire;
         }
         gfx.frame_idx = (gfx.frame_idx + 1) % gfx.frame_count;
+        cvk::release_buffers(ctx, gfx, this_frame);
+
+        if (scene.static_revision != gfx.static_revision)
+        {
+            const VkResult res_static{ cvk::upload_static(ctx, gfx, this_frame, scene) };
+            if (res_static != VK_SUCCESS)
+            {
+                // Do not retry every frame. The game has to replace the static geometry again.
+                CGE_LOG("[CGE] Static geometry upload failed.\n");
+                gfx.static_revision = scene.static_revision;
+            }
+        }
+
+        if (scene.mesh_revision != gfx.mesh_revision)
+        {
+            const VkResult res_meshes{ cvk::upload_meshes(ctx, gfx, this_frame, scene) };
+            if (res_meshes != VK_SUCCESS)
+            {
+                CGE_LOG("[CGE] Render failed. (Could not wait to replace meshes)\n");
+                return res_meshes;
+            }
+        }
 
         if (image_idx != this_frame)
         {
@@ -2024,7 +2927,7 @@ namespace cvk
             CGE_ASSERT(image_idx == this_frame);
         }
 
-        const VkResult res_record{ cvk::record_commands(gfx, image_idx, scene) };
+        const VkResult res_record{ cvk::record_commands(ctx, gfx, image_idx, scene) };
         if (res_record != VK_SUCCESS)
         {
             CGE_LOG("[CGE] Render failed. (Could not record commands)\n");
@@ -2050,6 +2953,71 @@ namespace cvk
         return VK_SUCCESS;
     }
 
+    void lend_scene(cvk::Context& ctx, cvk::Renderable& gfx, cge::Scene& scene) noexcept
+    {
+        if (!gfx.buffer_main || (gfx.frame_count == 0))
+        {
+            scene.unborrow();
+            return;
+        }
+
+        const cvk::Offset frame_idx{ gfx.frame_idx };
+
+        // The game writes into this frame's region as soon as the Scene is lent, so its previous submission must be finished.
+        // The fence is left signaled, to be reset by `cvk::acquire_image`.
+        const VkResult res_wait{ cvk::wait_frames(gfx, std::uint64_t(1) << frame_idx) };
+        if (res_wait != VK_SUCCESS)
+        {
+            scene.unborrow();
+            return;
+        }
+
+        const auto align_lend = [](const VkDeviceSize size) -> VkDeviceSize {
+            return (size + cvk::min_lend_size - 1) & ~(cvk::min_lend_size - 1);
+        };
+
+        // Leave headroom over last frame, so that a growing Scene rarely falls back to owned storage.
+        std::array<VkDeviceSize, cvk::num_streams> lend_size{};
+        VkDeviceSize total_size{};
+        for (std::size_t idx{}; idx < cvk::num_streams; ++idx)
+        {
+            lend_size[idx] = align_lend(std::max(gfx.lend_hint[idx] + gfx.lend_hint[idx] / 2, cvk::min_lend_size));
+            total_size += lend_size[idx];
+        }
+
+        if (total_size > gfx.buffer_region)
+        {
+            // Nothing is lent from the current buffer at this point, so it can be retired.
+            const VkResult res_grow{ cvk::grow_buffers(ctx, gfx, frame_idx, total_size) };
+            (void)res_grow;
+        }
+
+        if (total_size > gfx.buffer_region)
+        {
+            // Still too small, so share out what there is. Whatever does not fit is copied as usual.
+            const VkDeviceSize slice{ (gfx.buffer_region / cvk::num_streams) & ~(cvk::min_lend_size - 1) };
+            lend_size.fill(slice);
+        }
+
+        std::byte* const region{ static_cast<std::byte*>(gfx.buffer_mapped) + gfx.buffer_region * frame_idx };
+        std::array<std::byte*, cvk::num_streams> slices{};
+        {
+            VkDeviceSize offs{};
+            for (std::size_t idx{}; idx < cvk::num_streams; ++idx)
+            {
+                slices[idx] = region + offs;
+                offs += lend_size[idx];
+            }
+        }
+
+        // Same order as the streams in `cvk::record_commands`.
+        scene.vertices.borrow(reinterpret_cast<cge::Vertex*>(slices[0]), lend_size[0] / sizeof(cge::Vertex));
+        scene.vertices_2d.borrow(reinterpret_cast<cge::Vertex2D*>(slices[1]), lend_size[1] / sizeof(cge::Vertex2D));
+        scene.indices.borrow(reinterpret_cast<cge::Index*>(slices[2]), lend_size[2] / sizeof(cge::Index));
+        scene.indices_2d.borrow(reinterpret_cast<cge::Index*>(slices[3]), lend_size[3] / sizeof(cge::Index));
+        scene.sprites.borrow(reinterpret_cast<cge::Sprite*>(slices[cvk::stream_sprites]), lend_size[cvk::stream_sprites] / sizeof(cge::Sprite));
+    }
+
     VkResult acquire_image(cvk::Renderable& gfx, cvk::Offset& acquired_idx, const VkSemaphore signal_sem, const std::span<const VkFence> wait_fences, const std::span<const VkFence> reset_fences) noexcept
     {
         constexpr std::uint64_t no_timeout{ std::uint64_t(~0) };
@@ -2069,16 +3037,10 @@ namespace cvk
         return res_acquire;
     }
 
-    VkResult record_commands(cvk::Renderable& gfx, const cvk::Offset frame_idx, const cge::Scene& scene) noexcept
+    VkResult record_commands(cvk::Context& ctx, cvk::Renderable& gfx, const cvk::Offset frame_idx, const cge::Scene& scene) noexcept
     {
         // ----------------------------------------------------------------
 
-        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkResetCommandBuffer.html
-        const VkResult res_reset{ vkResetCommandBuffer(gfx.frame_commands[frame_idx], 0) };
-        if (res_reset != VK_SUCCESS) return res_reset;
-
-        // ----------------------------------------------------------------
-
         const cge::Viewport view{ cge::viewport(gfx.surface_extent.width, gfx.surface_extent.height, scene.res_w, scene.res_h, scene.scaling) };
         
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkViewport.html
@@ -2129,82 +3091,131 @@ namespace cvk
                 }
             }
         };
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkClearValue.html
+        const VkClearValue clear_depth{
+            .depthStencil = {
+                .depth = 1.0f,
+                .stencil = 0,
+            }
+        };
+        const std::array clear_values{ clear_value, clear_depth };
 
         // ----------------------------------------------------------------
 
-        using VertexSpan = std::span<const cge::Vertex>;
         using IndexSpan = std::span<const cge::Index>;
         using ByteSpan = std::span<const std::byte>;
 
-        const std::array<VertexSpan, cvk::num_pipelines> vertices{
-            /* Triangles */ VertexSpan{scene.vertices},
+        const std::array<std::size_t, cvk::num_pipelines> vertices{
+            /* Triangles   */ scene.vertices.size(),
+            /* Triangles2D */ scene.vertices_2d.size(),
         };
 
         const std::array<IndexSpan, cvk::num_pipelines> indices{
-            /* Triangles */ IndexSpan{scene.indices},
+            /* Triangles   */ IndexSpan{scene.indices},
+            /* Triangles2D */ IndexSpan{scene.indices_2d},
         };
 
         const std::array<ByteSpan, cvk::num_pipelines> vtx_bytes{
-            /* Triangles */ std::as_bytes(std::span{scene.vertices}),
+            /* Triangles   */ std::as_bytes(std::span{scene.vertices}),
+            /* Triangles2D */ std::as_bytes(std::span{scene.vertices_2d}),
         };
         const std::array<ByteSpan, cvk::num_pipelines> idx_bytes{
-            /* Triangles */ std::as_bytes(std::span{scene.indices}),
+            /* Triangles   */ std::as_bytes(std::span{scene.indices}),
+            /* Triangles2D */ std::as_bytes(std::span{scene.indices_2d}),
         };
 
         const std::array<VkDescriptorSet, cvk::num_pipelines> descriptor_sets{
-            /* Triangles */ gfx.descriptor_set,
+            /* Triangles   */ gfx.descriptor_set,
+            /* Triangles2D */ gfx.descriptor_set,
         };
 
         const std::array<VkPipeline, cvk::num_pipelines> pipeline_handles{
-            /* Triangles */ gfx.pipelines_graphics[0],
+            /* Triangles   */ gfx.pipelines_graphics[0],
+            /* Triangles2D */ gfx.pipelines_graphics[1],
         };
 
         const std::array<VkPipelineLayout, cvk::num_pipelines> pipeline_layouts{
-            /* Triangles */ gfx.pipeline_layout,
+            /* Triangles   */ gfx.pipeline_layout,
+            /* Triangles2D */ gfx.pipeline_layout,
+        };
+
+        static_assert(cge::num_passes == cvk::num_pipelines + 2);
+
+        const std::array<VkPipeline, cge::num_passes> pass_pipelines{
+            /* Opaque      */ gfx.pipelines_graphics[cvk::pipeline_opaque],
+            /* Triangles   */ pipeline_handles[0],
+            /* Triangles2D */ pipeline_handles[1],
+            /* Sprites     */ gfx.pipelines_graphics[cvk::pipeline_sprite],
+        };
+
+        // The stream pipeline whose geometry each pass draws. Sprites have their own instance stream instead.
+        const std::array<std::size_t, cge::num_passes> pass_geometry{
+            /* Opaque      */ 0,
+            /* Triangles   */ 0,
+            /* Triangles2D */ 1,
+            /* Sprites     */ cvk::num_pipelines,
         };
 
         // ----------------------------------------------------------------
 
-        std::array<VkDeviceSize, cvk::num_pipelines> vtx_offs{};
-        std::array<VkDeviceSize, cvk::num_pipelines> idx_offs{};
+        std::array<cvk::Stream, num_streams> streams{};
+        std::array<VkBuffer, num_streams> stream_buffers{};
+        std::array<VkDeviceSize, num_streams> stream_offsets{};
+        std::array<VkIndexType, cvk::num_pipelines> index_types{};
 
-        const VkDeviceMemory buffer_memory{ gfx.buffer_memory };
-        const VkDeviceSize buffer_offs{ 0 };
-        const VkDeviceSize buffer_size{ gfx.buffer_capacity };
+        for (std::size_t idx{}; idx < cvk::num_pipelines; ++idx)
         {
-            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkMapMemory.html
-            void* buffer;
-            const VkResult res_map{ vkMapMemory(gfx.device, buffer_memory, buffer_offs, buffer_size, 0, &buffer) };
-            if (res_map != VK_SUCCESS) return res_map;
+            // Indices built in place are drawn as they are, rather than narrowed into another copy.
+            const bool lent{ cvk::is_lent(gfx, frame_idx, idx_bytes[idx]) };
+            const bool narrow{ !lent && (vertices[idx] <= cvk::max_index16_vertices) };
+            index_types[idx] = narrow ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
 
-            {
-                VkDeviceSize offset{};
+            streams[idx] = cvk::Stream{ .bytes = vtx_bytes[idx], .narrow = false };
+            streams[cvk::num_pipelines + idx] = cvk::Stream{ .bytes = idx_bytes[idx], .narrow = narrow };
+        }
 
-                for (std::size_t idx{}; idx < cvk::num_pipelines; ++idx)
-                {
-                    const VkDeviceSize rel_offs{ offset - buffer_offs };
-                    const VkDeviceSize rel_size{ static_cast<VkDeviceSize>(vtx_bytes[idx].size()) };
-                    const VkDeviceSize rel_end{ rel_offs + rel_size };
-                    CGE_ASSERT(rel_end <= buffer_size);
+        streams[cvk::stream_sprites] = cvk::Stream{ .bytes = std::as_bytes(std::span{ scene.sprites }), .narrow = false };
 
-                    vtx_offs[idx] = cvk::map_bytes(buffer_size, buffer, offset, vtx_bytes[idx]);
-                }
+        for (std::size_t idx{}; idx < num_streams; ++idx)
+            gfx.lend_hint[idx] = streams[idx].bytes.size();
 
-                for (std::size_t idx{}; idx < cvk::num_pipelines; ++idx)
-                {
-                    const VkDeviceSize rel_offs{ offset - buffer_offs };
-                    const VkDeviceSize rel_size{ static_cast<VkDeviceSize>(idx_bytes[idx].size()) };
-                    const VkDeviceSize rel_end{ rel_offs + rel_size };
-                    CGE_ASSERT(rel_end <= buffer_size);
+        const VkResult res_upload{ cvk::upload_geometry(ctx, gfx, frame_idx, streams, stream_buffers, stream_offsets) };
+        if (res_upload != VK_SUCCESS) return res_upload;
 
-                    idx_offs[idx] = cvk::map_bytes(buffer_size, buffer, offset, idx_bytes[idx]);
-                }
-            }
+        // ----------------------------------------------------------------
+
+        // The commands only depend on where the geometry is and how it is split into draws, not on what it contains.
+        // If none of that changed since this image's commands were recorded, they are submitted again as they are.
+        std::uint64_t command_key{};
+        {
+            const std::array<std::uint64_t, 15> shape{
+                gfx.surface_extent.width, gfx.surface_extent.height,
+                std::uint64_t(std::int64_t(view.x)), std::uint64_t(std::int64_t(view.y)), view.w, view.h,
+                scene.backcolor,
+                gfx.static_revision, gfx.static_vtx_count, gfx.static_idx_count, std::uint64_t(gfx.static_idx_type),
+                gfx.mesh_revision,
+                std::uint64_t(!indices[0].empty()), std::uint64_t(!indices[1].empty()),
+                std::uint64_t(gfx.static_buffer != VK_NULL_HANDLE),
+            };
 
-            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkUnmapMemory.html
-            vkUnmapMemory(gfx.device, buffer_memory);
+            command_key = cge::hash_bytes(gfx.command_epoch, std::as_bytes(std::span{ shape }));
+            command_key = cge::hash_bytes(command_key, std::as_bytes(std::span{ stream_buffers }));
+            command_key = cge::hash_bytes(command_key, std::as_bytes(std::span{ stream_offsets }));
+            command_key = cge::hash_bytes(command_key, std::as_bytes(std::span{ index_types }));
+            command_key = cge::hash_bytes(command_key, std::as_bytes(std::span{ scene.mesh_draws }));
+            command_key = cge::hash_bytes(command_key, std::as_bytes(std::span{ scene.items }));
+            command_key = cge::hash_bytes(command_key, std::as_bytes(std::span{ scene.clips }));
+            command_key = cge::hash_bytes(command_key, std::as_bytes(std::span{ scene.transforms }));
+            command_key = command_key ? command_key : 1;
         }
 
+        if (command_key == gfx.frame_command_key[frame_idx]) return VK_SUCCESS;
+        gfx.frame_command_key[frame_idx] = {};
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkResetCommandBuffer.html
+        const VkResult res_reset{ vkResetCommandBuffer(gfx.frame_commands[frame_idx], 0) };
+        if (res_reset != VK_SUCCESS) return res_reset;
+
         // ----------------------------------------------------------------
 
         const VkRenderPass render_pass{ gfx.render_pass };
@@ -2229,24 +3240,116 @@ namespace cvk
                 .renderPass = render_pass,
                 .framebuffer = frame_buffer,
                 .renderArea = image_rect,
-                .clearValueCount = 1,
-                .pClearValues = &clear_value,
+                .clearValueCount = static_cast<cvk::Offset>(clear_values.size()),
+                .pClearValues = clear_values.data(),
             };
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdBeginRenderPass.html
             vkCmdBeginRenderPass(command_buffer, &pass_info, VK_SUBPASS_CONTENTS_INLINE);
             {
-                for (std::size_t idx{}; idx < cvk::num_pipelines; ++idx)
+                const auto draw_items = [&](const std::span<const cge::DrawItem> run) {
+                    // Items are sorted by state, so each pass is bound once per run of its items rather than once per item.
+                    std::size_t bound_pass{ cge::num_passes };
+                    cge::uint bound_clip{ cvk::null_idx };
+                    cge::uint bound_transform{ cvk::null_idx };
+                    for (const cge::DrawItem& item : run)
+                    {
+                        const std::size_t pass{ static_cast<std::size_t>(cge::draw_pass(item.key)) };
+                        if (pass >= cge::num_passes) continue;
+
+                        const std::size_t geom{ pass_geometry[pass] };
+                        const bool is_sprite{ pass == static_cast<std::size_t>(cge::Pass::sprites) };
+                        const bool has_idx{ !is_sprite && !indices[geom].empty() };
+
+                        if (pass != bound_pass)
+                        {
+                            const std::size_t vtx_stream{ is_sprite ? cvk::stream_sprites : geom };
+                            const VkBuffer vtx_buffer{ stream_buffers[vtx_stream] };
+                            const VkDeviceSize vtx_offset{ stream_offsets[vtx_stream] };
+                            const VkDescriptorSet desc_set{ is_sprite ? gfx.descriptor_set : descriptor_sets[geom] };
+                            const VkPipelineLayout layout{ is_sprite ? gfx.pipeline_layout : pipeline_layouts[geom] };
+
+                            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdBindPipeline.html
+                            vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pass_pipelines[pass]);
+
+                            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdSetViewport.html
+                            vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+
+                            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdBindVertexBuffers.html
+                            vkCmdBindVertexBuffers(command_buffer, 0, 1, &vtx_buffer, &vtx_offset);
+
+                            if (has_idx)
+                            {
+                                // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdBindIndexBuffer.html
+                                vkCmdBindIndexBuffer(command_buffer, stream_buffers[cvk::num_pipelines + geom], stream_offsets[cvk::num_pipelines + geom], index_types[geom]);
+                            }
+
+                            if (desc_set)
+                            {
+                                // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdBindDescriptorSets.html
+                                vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &desc_set, 0, nullptr);
+                            }
+
+                            bound_pass = pass;
+                            bound_clip = cvk::null_idx;
+                            bound_transform = cvk::null_idx;
+                        }
+
+                        if (item.clip != bound_clip)
+                        {
+                            const VkRect2D item_scissor{ cvk::clip_scissor(gfx, view, scene, item.clip) };
+
+                            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdSetScissor.html
+                            vkCmdSetScissor(command_buffer, 0, 1, &item_scissor);
+
+                            bound_clip = item.clip;
+                        }
+
+                        if (item.transform != bound_transform)
+                        {
+                            const bool transformed{ (item.transform != 0) && (item.transform <= scene.transforms.size()) };
+                            const cge::DrawTransform untransformed{ .transform = cge::identity, .tint = 0xFFFFFFFF };
+                            const cge::DrawTransform& transform{ transformed ? scene.transforms[item.transform - 1] : untransformed };
+                            const cvk::DrawConstants constants{ cvk::draw_constants(transform.transform, transform.tint) };
+                            const VkPipelineLayout layout{ is_sprite ? gfx.pipeline_layout : pipeline_layouts[geom] };
+
+                            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdPushConstants.html
+                            vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, static_cast<cvk::Offset>(sizeof(constants)), &constants);
+
+                            bound_transform = item.transform;
+                        }
+
+                        if (is_sprite)
+                        {
+                            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdDraw.html
+                            vkCmdDraw(command_buffer, 4, item.count, 0, item.first);
+                        }
+                        else if (has_idx)
+                        {
+                            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdDrawIndexed.html
+                            vkCmdDrawIndexed(command_buffer, item.count, 1, item.first, 0, 0);
+                        }
+                        else
+                        {
+                            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdDraw.html
+                            vkCmdDraw(command_buffer, item.count, 1, item.first, 0);
+                        }
+                    }
+                };
+
+                // Opaque items write depth, which static geometry and meshes only test against, so they are drawn before both.
+                const std::span<const cge::DrawItem> items{ scene.items };
+                const std::size_t opaque_count{ static_cast<std::size_t>(std::ranges::find_if(items, [](const cge::DrawItem& item) { return cge::draw_pass(item.key) != cge::Pass::opaque; }) - items.begin()) };
+                draw_items(items.first(opaque_count));
+
+                if (gfx.static_buffer)
                 {
-                    const VkDeviceSize vtx_offset{ vtx_offs[idx] };
-                    const VkDeviceSize idx_offset{ idx_offs[idx] };
-                    const VkDescriptorSet desc_set{ descriptor_sets[idx] };
-                    const VkPipelineLayout layout{ pipeline_layouts[idx] };
-                    const cvk::Offset vtx_count{ static_cast<cvk::Offset>(vertices[idx].size()) };
-                    const cvk::Offset idx_count{ static_cast<cvk::Offset>(indices[idx].size()) };
-                    const bool has_idx{ indices[idx].data() != nullptr };
+                    const VkDeviceSize vtx_offset{ 0 };
+                    const VkDescriptorSet desc_set{ descriptor_sets[0] };
+                    const VkPipelineLayout layout{ pipeline_layouts[0] };
+                    const bool has_idx{ gfx.static_idx_count > 0 };
 
                     // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdBindPipeline.html
-                    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_handles[idx]);
+                    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline_handles[0]);
 
                     // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdSetViewport.html
                     vkCmdSetViewport(command_buffer, 0, 1, &viewport);
@@ -2255,12 +3358,12 @@ namespace cvk
                     vkCmdSetScissor(command_buffer, 0, 1, &scissor);
 
                     // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdBindVertexBuffers.html
-                    vkCmdBindVertexBuffers(command_buffer, 0, 1, &gfx.buffer_main, &vtx_offset);
+                    vkCmdBindVertexBuffers(command_buffer, 0, 1, &gfx.static_buffer, &vtx_offset);
 
                     if (has_idx)
                     {
                         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdBindIndexBuffer.html
-                        vkCmdBindIndexBuffer(command_buffer, gfx.buffer_main, idx_offset, VK_INDEX_TYPE_UINT32);
+                        vkCmdBindIndexBuffer(command_buffer, gfx.static_buffer, gfx.static_idx_offs, gfx.static_idx_type);
                     }
 
                     if (desc_set)
@@ -2269,17 +3372,85 @@ namespace cvk
                         vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &desc_set, 0, nullptr);
                     }
 
+                    const cvk::DrawConstants constants{ cvk::draw_constants(cge::identity, 0xFFFFFFFF) };
+                    // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdPushConstants.html
+                    vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, static_cast<cvk::Offset>(sizeof(constants)), &constants);
+
                     if (has_idx)
                     {
                         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdDrawIndexed.html
-                        vkCmdDrawIndexed(command_buffer, idx_count, 1, 0, 0, 0);
+                        vkCmdDrawIndexed(command_buffer, gfx.static_idx_count, 1, 0, 0, 0);
                     }
                     else
                     {
                         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdDraw.html
-                        vkCmdDraw(command_buffer, vtx_count, 1, 0, 0);
+                        vkCmdDraw(command_buffer, gfx.static_vtx_count, 1, 0, 0);
+                    }
+                }
+
+                if (!scene.mesh_draws.empty())
+                {
+                    const VkDescriptorSet desc_set{ gfx.descriptor_set };
+                    const VkPipelineLayout layout{ gfx.pipeline_layout };
+
+                    // Meshes are made of `cge::Vertex`, so they are drawn with the same pipeline as the Scene's 3D triangles.
+                    // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdBindPipeline.html
+                    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, gfx.pipelines_graphics[0]);
+
+                    // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdSetViewport.html
+                    vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+
+                    // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdSetScissor.html
+                    vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+
+                    if (desc_set)
+                    {
+                        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdBindDescriptorSets.html
+                        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, 0, 1, &desc_set, 0, nullptr);
+                    }
+
+                    cvk::Offset bound_idx{ cvk::null_idx };
+                    for (const cge::MeshDraw& draw : scene.mesh_draws)
+                    {
+                        const cvk::Offset mesh_idx{ draw.mesh.id - 1 };
+                        if ((draw.mesh.id == 0) || (mesh_idx >= gfx.meshes.size())) continue;
+
+                        const cvk::ResidentMesh& mesh{ gfx.meshes[mesh_idx] };
+                        if (!mesh.buffer) continue;
+
+                        if (mesh_idx != bound_idx)
+                        {
+                            const VkDeviceSize vtx_offset{ 0 };
+
+                            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdBindVertexBuffers.html
+                            vkCmdBindVertexBuffers(command_buffer, 0, 1, &mesh.buffer, &vtx_offset);
+
+                            if (mesh.idx_count > 0)
+                            {
+                                // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdBindIndexBuffer.html
+                                vkCmdBindIndexBuffer(command_buffer, mesh.buffer, mesh.idx_offs, mesh.idx_type);
+                            }
+                            bound_idx = mesh_idx;
+                        }
+
+                        const cvk::DrawConstants constants{ cvk::draw_constants(draw.transform, draw.tint) };
+                        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdPushConstants.html
+                        vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_VERTEX_BIT, 0, static_cast<cvk::Offset>(sizeof(constants)), &constants);
+
+                        if (mesh.idx_count > 0)
+                        {
+                            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdDrawIndexed.html
+                            vkCmdDrawIndexed(command_buffer, mesh.idx_count, 1, 0, 0, 0);
+                        }
+                        else
+                        {
+                            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdDraw.html
+                            vkCmdDraw(command_buffer, mesh.vtx_count, 1, 0, 0);
+                        }
                     }
                 }
+
+                draw_items(items.subspan(opaque_count));
             }
             // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkCmdEndRenderPass.html
             vkCmdEndRenderPass(command_buffer);
@@ -2288,11 +3459,58 @@ namespace cvk
         const VkResult res_end{ vkEndCommandBuffer(command_buffer) };
         if (res_end != VK_SUCCESS) return res_end;
 
+        gfx.frame_command_key[frame_idx] = command_key;
+
         // ----------------------------------------------------------------
 
         return VK_SUCCESS;
     }
 
+    VkRect2D clip_scissor(const cvk::Renderable& gfx, const cge::Viewport& view, const cge::Scene& scene, const cge::uint clip) noexcept
+    {
+        const double surface_w{ double(gfx.surface_extent.width) };
+        const double surface_h{ double(gfx.surface_extent.height) };
+
+        double x0{ 0.0 }, y0{ 0.0 }, x1{ surface_w }, y1{ surface_h };
+        if ((clip != 0) && (clip <= scene.clips.size()) && scene.res_w && scene.res_h)
+        {
+            // Scales the rectangle from Scene resolution onto the part of the surface the Scene is drawn into.
+            const cge::ClipRect& rect{ scene.clips[clip - 1] };
+            const double scale_x{ double(view.w) / double(scene.res_w) };
+            const double scale_y{ double(view.h) / double(scene.res_h) };
+            x0 = std::clamp(std::floor(double(view.x) + double(rect.x) * scale_x), 0.0, surface_w);
+            y0 = std::clamp(std::floor(double(view.y) + double(rect.y) * scale_y), 0.0, surface_h);
+            x1 = std::clamp(std::ceil(double(view.x) + (double(rect.x) + double(rect.w)) * scale_x), x0, surface_w);
+            y1 = std::clamp(std::ceil(double(view.y) + (double(rect.y) + double(rect.h)) * scale_y), y0, surface_h);
+        }
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkRect2D.html
+        return VkRect2D{
+            .offset = {
+                .x = static_cast<std::int32_t>(x0),
+                .y = static_cast<std::int32_t>(y0),
+            },
+            .extent = {
+                .width = static_cast<cvk::Offset>(x1 - x0),
+                .height = static_cast<cvk::Offset>(y1 - y0),
+            },
+        };
+    }
+
+    cvk::DrawConstants draw_constants(const cge::mat4& transform, const cge::Color tint) noexcept
+    {
+        const float tint_b{ float((tint      ) & 0xFF) / 255.0f };
+        const float tint_g{ float((tint >>  8) & 0xFF) / 255.0f };
+        const float tint_r{ float((tint >> 16) & 0xFF) / 255.0f };
+        const float tint_a{ float((tint >> 24) & 0xFF) / 255.0f };
+
+        // The shaders blend in linear space, so the tint is decoded from sRGB like the vertex colours.
+        return cvk::DrawConstants{
+            .transform = transform,
+            .tint = { cge::from_srgb(tint_r), cge::from_srgb(tint_g), cge::from_srgb(tint_b), tint_a },
+        };
+    }
+
     VkResult submit_commands(cvk::Renderable& gfx, const cvk::Offset frame_idx, const std::span<const VkSemaphore> wait_sems, const std::span<const VkSemaphore> signal_sems, const VkFence signal_fence) noexcept
     {
         // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPipelineStageFlags.html
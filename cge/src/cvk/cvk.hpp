@@ -34,6 +34,8 @@
 
 #include <cge.hpp>
 #include "../engine.hpp"
+#include "memory.hpp"
+#include "host.hpp"
 
 // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkGetInstanceProcAddr.html
 #define CVK_LOAD_INSTANCE(instance, var, func) var.func = reinterpret_cast<PFN_##func>(vkGetInstanceProcAddr(instance, #func))
@@ -107,11 +109,52 @@ namespace cvk
     using Offset = std::uint32_t;
     using Ranking = std::uint64_t;
 
-    static inline constexpr cge::Color default_color{};
+    /// White, so that geometry which always samples the atlas (`cge::Vertex2D`) shows its own colour when no atlas is uploaded.
+    static inline constexpr cge::Color default_color{ 0xFFFFFFFF };
     static inline constexpr cge::Texture default_texture{ .width = 1, .height = 1, .data = &default_color };
 
     static inline constexpr decltype(auto) shader_entry{ "main" };
-    static inline constexpr std::size_t num_pipelines{ 1 };
+    static inline constexpr std::size_t num_pipelines{ 2 }; ///< Pipelines that draw the Scene's per-frame geometry streams.
+
+    /// Indices of the other pipelines in `Renderable::pipelines_graphics`. They follow the stream pipelines.
+    static inline constexpr std::size_t pipeline_sprite{ num_pipelines };
+    static inline constexpr std::size_t pipeline_opaque{ num_pipelines + 1 };
+    static inline constexpr std::size_t num_graphics_pipelines{ num_pipelines + 2 };
+
+    /// Depth attachment formats, in order of preference. `VK_FORMAT_D16_UNORM` is always supported.
+    static inline constexpr std::array depth_formats{ VK_FORMAT_D32_SFLOAT, VK_FORMAT_X8_D24_UNORM_PACK32, VK_FORMAT_D16_UNORM };
+
+    /// Which memory host-written buffers (the upload ring, overflow and staging buffers) are placed in.
+    enum class UploadMemory
+    {
+        automatic, ///< Cached memory if it is also coherent (typical of integrated GPUs), otherwise coherent memory.
+        coherent, ///< Coherent memory. Usually uncached and write-combined, which is fast to stream into but slow to read back.
+        cached, ///< Cached memory, with the written ranges flushed explicitly if it is not coherent.
+    };
+
+#if defined(CGE_UPLOAD_MEMORY_COHERENT)
+    static inline constexpr cvk::UploadMemory upload_memory{ cvk::UploadMemory::coherent };
+#elif defined(CGE_UPLOAD_MEMORY_CACHED)
+    static inline constexpr cvk::UploadMemory upload_memory{ cvk::UploadMemory::cached };
+#else
+    static inline constexpr cvk::UploadMemory upload_memory{ cvk::UploadMemory::automatic };
+#endif
+
+    /// Upper bound for the per-frame region of the upload ring. Larger frames spill into per-frame overflow buffers.
+    static inline constexpr VkDeviceSize max_buffer_region{ VkDeviceSize(256) << 20 };
+
+    /// Start of every stream in the upload ring is aligned to this, so any index type can follow any other stream.
+    static inline constexpr VkDeviceSize stream_align{ 4 };
+
+    /// Geometry with at most this many vertices has its indices narrowed to `VK_INDEX_TYPE_UINT16` on upload.
+    static inline constexpr std::size_t max_index16_vertices{ std::size_t(1) << 16 };
+
+    /// Dynamic geometry streams per frame: the vertices of each pipeline, then the indices of each pipeline, then the sprite instances.
+    static inline constexpr std::size_t stream_sprites{ num_pipelines * 2 };
+    static inline constexpr std::size_t num_streams{ num_pipelines * 2 + 1 };
+
+    /// Smallest slice of the upload ring lent to each stream of a zero-copy Scene. Lent slices are aligned to this too.
+    static inline constexpr VkDeviceSize min_lend_size{ VkDeviceSize(64) << 10 };
 
     static inline constexpr cvk::Offset null_idx{ ~cvk::Offset{} };
 
@@ -119,13 +162,36 @@ namespace cvk
     constexpr cvk::Offset special_value{ ~cvk::Offset{} };
 }
 
+namespace cvk
+{
+    /// Push constants of every graphics pipeline. Matches `DrawConstants` in the vertex shaders.
+    struct DrawConstants
+    {
+        cge::mat4 transform;
+        cge::vec4 tint; ///< Linear RGBA.
+    };
+    static_assert(sizeof(cvk::DrawConstants) == 80);
+
+    /// GPU copy of a `cge::MeshData`: vertices, then indices, in one device-local buffer.
+    struct ResidentMesh
+    {
+        VkBuffer        buffer   ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkBuffer.html
+        cvk::Allocation memory   ;
+        VkDeviceSize    idx_offs ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDeviceSize.html
+        Offset          vtx_count;
+        Offset          idx_count;
+        VkIndexType     idx_type ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkIndexType.html
+        std::uint64_t   revision ; ///< Matches `cge::MeshData::revision` once that mesh is resident.
+    };
+}
+
 namespace cvk
 {
     struct Context
     {
         InstanceFunctions pfn;
         
-        VkAllocationCallbacks* allocator;
+        cvk::HostAllocator host; ///< Receives every host allocation the driver makes. See `cvk::allocator`.
 
         VkInstance             instance          ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkInstance.html
     #if defined(CGE_DEBUG)
@@ -163,9 +229,11 @@ namespace cvk
         Offset   sel_device  ;
         Offset   sel_graphics;
         Offset   sel_present ;
+        Offset   sel_transfer;
         VkDevice device        ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDevice.html
         VkQueue  queue_graphics; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkQueue.html
         VkQueue  queue_present ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkQueue.html
+        VkQueue  queue_transfer; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkQueue.html
 
         Offset                    ds_present_count;
         Offset                    ds_formats_count;
@@ -177,14 +245,38 @@ namespace cvk
         VkPresentModeKHR   surface_present; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPresentModeKHR.html
         VkExtent2D         surface_extent ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkExtent2D.html
         bool               surface_vsync  ;
+
+        std::vector<cvk::Heap> heaps; ///< `VkDeviceMemory` blocks that buffers and images are sub-allocated from. See `cvk::allocate_memory`.
+        VkMemoryPropertyFlags  upload_memprops; ///< Memory properties of host-written buffers, picked for the device by `cvk::select_upload_memory`.
         
         VkBuffer             buffer_main    ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkBuffer.html
-        VkDeviceMemory       buffer_memory  ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDeviceMemory.html
+        cvk::Allocation      buffer_memory  ;
         VkDeviceSize         buffer_capacity; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDeviceSize.html
+        VkDeviceSize         buffer_region  ; ///< Bytes reserved for each frame-in-flight. Frame `i` owns `[i * buffer_region, (i + 1) * buffer_region)`.
+        void*                buffer_mapped  ; ///< Persistent host mapping of the whole `buffer_memory`, valid until `deinit_buffers`.
+
+        VkBuffer       buffer_retired       ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkBuffer.html
+        cvk::Allocation buffer_retired_memory;
+        void*          buffer_retired_mapped;
+        std::uint64_t  buffer_retired_frames; ///< Bitmask of frames that may still read `buffer_retired`. It is destroyed once this reaches zero.
         VkMemoryRequirements buffer_memreqs ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkMemoryRequirements.html
+        std::array<VkDeviceSize, num_streams> lend_hint; ///< Bytes each stream used last frame. Sizes the slices lent by `cvk::lend_scene`.
 
-        VkCommandPool command_pool; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkCommandPool.html
+        VkBuffer       static_buffer   ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkBuffer.html
+        cvk::Allocation static_memory  ;
+        VkDeviceSize   static_idx_offs ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDeviceSize.html
+        Offset         static_vtx_count;
+        Offset         static_idx_count;
+        VkIndexType    static_idx_type ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkIndexType.html
+        std::uint64_t  static_revision ; ///< Matches `cge::Scene::static_revision` once that geometry is resident.
+
+        std::vector<cvk::ResidentMesh> meshes; ///< Indexed like `cge::Scene::meshes`.
+        std::uint64_t mesh_revision; ///< Matches `cge::Scene::mesh_revision` once every mesh is resident.
+
+        VkCommandPool command_pool ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkCommandPool.html
+        VkCommandPool transfer_pool; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkCommandPool.html
         VkRenderPass  render_pass ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkRenderPass.html
+        VkFormat      depth_format; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkFormat.html
 
         VkSwapchainKHR   swapchain       ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkSwapchainKHR.html
         Offset           frame_idx       ;
@@ -196,23 +288,48 @@ namespace cvk
         VkFence*         frame_fence     ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkFence.html
         VkSemaphore*     frame_sem_render; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkSemaphore.html
         VkSemaphore*     frame_sem_image ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkSemaphore.html
+        VkBuffer*        frame_overflow         ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkBuffer.html
+        cvk::Allocation* frame_overflow_memory  ;
+        void**           frame_overflow_mapped  ;
+        VkDeviceSize*    frame_overflow_capacity; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDeviceSize.html
+        std::uint64_t*   frame_command_key      ; ///< Hash of everything `frame_commands` was recorded from, besides buffer contents. Zero if it must be re-recorded.
+        std::uint64_t    command_epoch          ; ///< Bumped whenever a buffer, image or descriptor that recorded commands may reference is destroyed or rewritten.
+
+        VkImage          depth_image ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkImage.html
+        VkImageView      depth_view  ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkImageView.html
+        cvk::Allocation  depth_memory; ///< Shared by every frame. The render pass orders each frame's depth writes after the previous frame's.
         
         Offset atlas_count;
         VkImage*              atlas_image  ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkImage.html
         VkImageView*          atlas_view   ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkImageView.html
         VkSampler*            atlas_sampler; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkSampler.html
         VkExtent2D*           atlas_extent ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkExtent2D.html
-        VkDeviceMemory*       atlas_memory ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDeviceMemory.html
+        cvk::Allocation*      atlas_memory ;
         VkMemoryRequirements* atlas_memreqs; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkMemoryRequirements
 
         VkShaderModule        module_vertex         ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkShaderModule.html
+        VkShaderModule        module_vertex_2d      ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkShaderModule.html
+        VkShaderModule        module_vertex_sprite  ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkShaderModule.html
         VkShaderModule        module_fragment       ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkShaderModule.html
         VkDescriptorSetLayout descriptor_layout     ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDescriptorSetLayout.html
         VkDescriptorPool      descriptor_pool       ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDescriptorPool.html
         VkDescriptorSet       descriptor_set        ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDescriptorSet.html
         VkPipelineLayout      pipeline_layout       ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPipelineLayout.html
-        VkPipeline pipelines_graphics[num_pipelines]; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPipeline.html
+        VkPipeline pipelines_graphics[num_graphics_pipelines]; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkPipeline.html
+
+    };
 
+    /// Callbacks to pass wherever Vulkan takes a `const VkAllocationCallbacks*`. An object must be destroyed under the scope it was created with.
+    static inline const VkAllocationCallbacks* allocator(const cvk::Context& ctx, const cvk::HostScope scope) noexcept
+    {
+        return &ctx.host.callbacks[static_cast<std::size_t>(scope)];
+    }
+
+    /// A run of bytes to copy into the upload ring.
+    struct Stream
+    {
+        std::span<const std::byte> bytes;
+        bool narrow; ///< `bytes` holds `cge::Index` values, which are written out as 16-bit indices.
     };
 
     struct Vulkan
@@ -233,8 +350,21 @@ namespace cvk
     extern void upload_texture(cvk::Context& ctx, cvk::Renderable& gfx, Offset atlas_idx, cge::Texture tex) noexcept;
 
     extern VkResult render_frame(cvk::Context& ctx, cvk::Renderable& gfx, const cge::Scene& scene) noexcept;
+    extern void lend_scene(cvk::Context& ctx, cvk::Renderable& gfx, cge::Scene& scene) noexcept;
 
     extern void remake_swapchain(cvk::Context& ctx, cvk::Renderable& gfx, bool vsync) noexcept;
     extern VkExtent2D full_resolution(cvk::Context& ctx, cvk::Renderable& gfx, bool update) noexcept;
 
+    extern void reinit_host(cvk::Context& ctx) noexcept;
+    extern void deinit_host(cvk::Context& ctx) noexcept;
+    extern cvk::HostCounters host_counters(cvk::Context& ctx, cvk::HostScope scope) noexcept;
+    extern void log_host(cvk::Context& ctx) noexcept;
+
+    extern VkResult allocate_memory(cvk::Context& ctx, cvk::Renderable& gfx, const VkMemoryRequirements& reqs, VkMemoryPropertyFlags props, cvk::Strategy strategy, cvk::Allocation& alloc) noexcept;
+    extern void free_memory(cvk::Context& ctx, cvk::Renderable& gfx, cvk::Allocation& alloc) noexcept;
+    extern VkResult flush_memory(cvk::Context& ctx, cvk::Renderable& gfx, const cvk::Allocation& alloc, VkDeviceSize offset, VkDeviceSize size) noexcept;
+    extern void deinit_memory(cvk::Context& ctx, cvk::Renderable& gfx) noexcept;
+    extern cvk::HeapStats memory_stats(const cvk::Renderable& gfx, cvk::Offset heap_idx) noexcept;
+    extern void log_memory(const cvk::Renderable& gfx) noexcept;
+
 }
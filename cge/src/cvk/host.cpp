@@ -0,0 +1,322 @@
+/**
+ * @file cge/cvk/host.cpp
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+#include "cvk.hpp"
+
+#if !defined(CGE_HOST_MEMORY_LIMIT)
+    #define CGE_HOST_MEMORY_LIMIT 0
+#endif
+
+namespace cvk
+{
+    /// Stored immediately before every pointer handed to the driver.
+    struct HostHeader
+    {
+        std::size_t   size      ; ///< Bytes requested by the driver.
+        std::uint32_t size_class; ///< Index into `HostAllocator::free_slots`, or `num_classes` for system allocations.
+        std::uint32_t offset    ; ///< Distance from the start of the underlying allocation to the returned pointer.
+    };
+
+    static inline constexpr std::size_t host_header{ 16 };
+    static_assert(sizeof(cvk::HostHeader) <= host_header);
+
+    static VKAPI_ATTR void* VKAPI_CALL host_allocation(void* user, std::size_t size, std::size_t align, VkSystemAllocationScope scope) noexcept;
+    static VKAPI_ATTR void* VKAPI_CALL host_reallocation(void* user, void* original, std::size_t size, std::size_t align, VkSystemAllocationScope scope) noexcept;
+    static VKAPI_ATTR void VKAPI_CALL host_free(void* user, void* memory) noexcept;
+    static VKAPI_ATTR void VKAPI_CALL host_internal_allocation(void* user, std::size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope) noexcept;
+    static VKAPI_ATTR void VKAPI_CALL host_internal_free(void* user, std::size_t size, VkInternalAllocationType type, VkSystemAllocationScope scope) noexcept;
+
+    static void* host_acquire(cvk::HostAllocator& host, cvk::HostCounters& counters, std::size_t size, std::size_t align) noexcept;
+    static void host_release(cvk::HostAllocator& host, cvk::HostCounters& counters, void* memory) noexcept;
+    static cvk::HostHeader& host_header_of(void* memory) noexcept;
+    static constexpr std::size_t host_slot_size(std::uint32_t size_class) noexcept;
+    static constexpr const char* host_scope_name(cvk::HostScope scope) noexcept;
+}
+
+namespace cvk
+{
+    void reinit_host(cvk::Context& ctx) noexcept
+    {
+        cvk::HostAllocator& host{ ctx.host };
+
+        host.limit = std::size_t{ CGE_HOST_MEMORY_LIMIT };
+        host.current = {};
+        host.peak = {};
+        host.pooled = {};
+        host.scopes = {};
+        host.free_slots = {};
+
+        for (std::size_t idx{}; idx < cvk::num_host_scopes; ++idx)
+        {
+            host.bindings[idx] = cvk::HostBinding{
+                .host = &host,
+                .scope = static_cast<cvk::HostScope>(idx),
+            };
+
+            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkAllocationCallbacks.html
+            host.callbacks[idx] = VkAllocationCallbacks{
+                .pUserData = &host.bindings[idx],
+                .pfnAllocation = &cvk::host_allocation,
+                .pfnReallocation = &cvk::host_reallocation,
+                .pfnFree = &cvk::host_free,
+                .pfnInternalAllocation = &cvk::host_internal_allocation,
+                .pfnInternalFree = &cvk::host_internal_free,
+            };
+        }
+    }
+
+    void deinit_host(cvk::Context& ctx) noexcept
+    {
+        cvk::HostAllocator& host{ ctx.host };
+
+    #if defined(CGE_DEBUG)
+        cvk::log_host(ctx);
+        if (host.current > 0)
+            CGE_LOG("[CGE] Host allocator: {} bytes were never freed by the driver\n", host.current);
+    #endif
+
+        // Only chunks can be reclaimed here. Leaked system allocations have no record besides their header.
+        for (void* const chunk : host.chunks)
+        {
+            ::operator delete(chunk, std::align_val_t{ cvk::HostAllocator::min_slot });
+        }
+        host.chunks.clear();
+        host.free_slots = {};
+        host.pooled = {};
+    }
+
+    cvk::HostCounters host_counters(cvk::Context& ctx, const cvk::HostScope scope) noexcept
+    {
+        const std::scoped_lock lock{ ctx.host.mutex };
+        return ctx.host.scopes[static_cast<std::size_t>(scope)];
+    }
+
+    void log_host(cvk::Context& ctx [[maybe_unused]]) noexcept
+    {
+    #if defined(CGE_DEBUG)
+        const std::scoped_lock lock{ ctx.host.mutex };
+        const cvk::HostAllocator& host{ ctx.host };
+
+        CGE_LOG("[CGE] Host allocator: current {} | peak {} | pooled {} | limit {}\n", host.current, host.peak, host.pooled, host.limit);
+        for (std::size_t idx{}; idx < cvk::num_host_scopes; ++idx)
+        {
+            const cvk::HostCounters& counters{ host.scopes[idx] };
+            CGE_LOG("[CGE] - {:9} | current {:9} | peak {:9} | internal {:9} | {:7} allocs | {:7} frees | {} failed\n",
+                cvk::host_scope_name(static_cast<cvk::HostScope>(idx)),
+                counters.current, counters.peak, counters.internal, counters.allocations, counters.frees, counters.failures
+            );
+        }
+    #endif
+    }
+}
+
+namespace cvk
+{
+    VKAPI_ATTR void* VKAPI_CALL host_allocation(void* const user, const std::size_t size, const std::size_t align, const VkSystemAllocationScope scope [[maybe_unused]]) noexcept
+    {
+        cvk::HostBinding& binding{ *static_cast<cvk::HostBinding*>(user) };
+        cvk::HostAllocator& host{ *binding.host };
+        cvk::HostCounters& counters{ host.scopes[static_cast<std::size_t>(binding.scope)] };
+
+        if (size == 0) return nullptr;
+
+        const std::scoped_lock lock{ host.mutex };
+        return cvk::host_acquire(host, counters, size, align);
+    }
+
+    VKAPI_ATTR void* VKAPI_CALL host_reallocation(void* const user, void* const original, const std::size_t size, const std::size_t align, const VkSystemAllocationScope scope [[maybe_unused]]) noexcept
+    {
+        cvk::HostBinding& binding{ *static_cast<cvk::HostBinding*>(user) };
+        cvk::HostAllocator& host{ *binding.host };
+        cvk::HostCounters& counters{ host.scopes[static_cast<std::size_t>(binding.scope)] };
+
+        const std::scoped_lock lock{ host.mutex };
+
+        if (!original) return (size > 0) ? cvk::host_acquire(host, counters, size, align) : nullptr;
+
+        if (size == 0)
+        {
+            cvk::host_release(host, counters, original);
+            return nullptr;
+        }
+
+        cvk::HostHeader& header{ cvk::host_header_of(original) };
+        const std::size_t old_size{ header.size };
+
+        // Grow or shrink in place while the request still fits its slot.
+        const bool pooled{ header.size_class < cvk::HostAllocator::num_classes };
+        if (pooled && (align <= cvk::host_header) && (size + cvk::host_header <= cvk::host_slot_size(header.size_class)))
+        {
+            if ((size > old_size) && host.limit && (host.current + (size - old_size) > host.limit))
+            {
+                counters.failures += 1;
+                return nullptr;
+            }
+
+            host.current = host.current - old_size + size;
+            host.peak = std::max(host.peak, host.current);
+            counters.current = counters.current - old_size + size;
+            counters.peak = std::max(counters.peak, counters.current);
+            counters.allocations += 1;
+            header.size = size;
+            return original;
+        }
+
+        void* const memory{ cvk::host_acquire(host, counters, size, align) };
+        if (!memory) return nullptr;
+
+        std::memcpy(memory, original, std::min(old_size, size));
+        cvk::host_release(host, counters, original);
+        return memory;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL host_free(void* const user, void* const memory) noexcept
+    {
+        if (!memory) return;
+
+        cvk::HostBinding& binding{ *static_cast<cvk::HostBinding*>(user) };
+        cvk::HostAllocator& host{ *binding.host };
+        cvk::HostCounters& counters{ host.scopes[static_cast<std::size_t>(binding.scope)] };
+
+        const std::scoped_lock lock{ host.mutex };
+        cvk::host_release(host, counters, memory);
+    }
+
+    VKAPI_ATTR void VKAPI_CALL host_internal_allocation(void* const user, const std::size_t size, const VkInternalAllocationType type [[maybe_unused]], const VkSystemAllocationScope scope [[maybe_unused]]) noexcept
+    {
+        cvk::HostBinding& binding{ *static_cast<cvk::HostBinding*>(user) };
+        cvk::HostAllocator& host{ *binding.host };
+
+        const std::scoped_lock lock{ host.mutex };
+        host.scopes[static_cast<std::size_t>(binding.scope)].internal += size;
+    }
+
+    VKAPI_ATTR void VKAPI_CALL host_internal_free(void* const user, const std::size_t size, const VkInternalAllocationType type [[maybe_unused]], const VkSystemAllocationScope scope [[maybe_unused]]) noexcept
+    {
+        cvk::HostBinding& binding{ *static_cast<cvk::HostBinding*>(user) };
+        cvk::HostAllocator& host{ *binding.host };
+
+        const std::scoped_lock lock{ host.mutex };
+        host.scopes[static_cast<std::size_t>(binding.scope)].internal -= size;
+    }
+}
+
+namespace cvk
+{
+    void* host_acquire(cvk::HostAllocator& host, cvk::HostCounters& counters, const std::size_t size, const std::size_t align) noexcept
+    {
+        if (host.limit && (host.current + size > host.limit))
+        {
+            counters.failures += 1;
+            return nullptr;
+        }
+
+        std::byte* memory{};
+        std::uint32_t size_class{ cvk::HostAllocator::num_classes };
+        std::uint32_t offset{};
+
+        // Slots are `min_slot`-aligned, so the header leaves the returned pointer `host_header`-aligned.
+        if ((align <= cvk::host_header) && (size + cvk::host_header <= cvk::host_slot_size(cvk::HostAllocator::num_classes - 1)))
+        {
+            size_class = 0;
+            while (size + cvk::host_header > cvk::host_slot_size(size_class)) ++size_class;
+
+            void*& head{ host.free_slots[size_class] };
+            if (!head)
+            {
+                void* const chunk{ ::operator new(cvk::HostAllocator::chunk_size, std::align_val_t{ cvk::HostAllocator::min_slot }, std::nothrow) };
+                if (!chunk) return nullptr;
+                host.chunks.push_back(chunk);
+                host.pooled += cvk::HostAllocator::chunk_size;
+
+                const std::size_t slot_size{ cvk::host_slot_size(size_class) };
+                std::byte* const base{ static_cast<std::byte*>(chunk) };
+                for (std::size_t slot{ cvk::HostAllocator::chunk_size }; slot >= slot_size; slot -= slot_size)
+                {
+                    void* const this_slot{ base + slot - slot_size };
+                    *static_cast<void**>(this_slot) = head;
+                    head = this_slot;
+                }
+            }
+
+            std::byte* const slot{ static_cast<std::byte*>(head) };
+            head = *static_cast<void**>(head);
+
+            offset = cvk::host_header;
+            memory = slot + offset;
+        }
+        else
+        {
+            // The header sits in the first `align` bytes, which keeps the returned pointer aligned.
+            const std::size_t sys_align{ std::max(align, cvk::host_header) };
+            void* const raw{ ::operator new(sys_align + size, std::align_val_t{ sys_align }, std::nothrow) };
+            if (!raw) return nullptr;
+
+            offset = static_cast<std::uint32_t>(sys_align);
+            memory = static_cast<std::byte*>(raw) + offset;
+        }
+
+        cvk::host_header_of(memory) = cvk::HostHeader{
+            .size = size,
+            .size_class = size_class,
+            .offset = offset,
+        };
+
+        host.current += size;
+        host.peak = std::max(host.peak, host.current);
+        counters.current += size;
+        counters.peak = std::max(counters.peak, counters.current);
+        counters.allocations += 1;
+
+        return memory;
+    }
+
+    void host_release(cvk::HostAllocator& host, cvk::HostCounters& counters, void* const memory) noexcept
+    {
+        const cvk::HostHeader header{ cvk::host_header_of(memory) };
+
+        host.current -= header.size;
+        counters.current -= header.size;
+        counters.frees += 1;
+
+        std::byte* const raw{ static_cast<std::byte*>(memory) - header.offset };
+        if (header.size_class < cvk::HostAllocator::num_classes)
+        {
+            void*& head{ host.free_slots[header.size_class] };
+            *reinterpret_cast<void**>(raw) = head;
+            head = raw;
+        }
+        else
+        {
+            ::operator delete(raw, std::align_val_t{ header.offset });
+        }
+    }
+
+    cvk::HostHeader& host_header_of(void* const memory) noexcept
+    {
+        return *reinterpret_cast<cvk::HostHeader*>(static_cast<std::byte*>(memory) - cvk::host_header);
+    }
+
+    constexpr std::size_t host_slot_size(const std::uint32_t size_class) noexcept
+    {
+        return cvk::HostAllocator::min_slot << size_class;
+    }
+
+    constexpr const char* host_scope_name(const cvk::HostScope scope) noexcept
+    {
+        switch (scope)
+        {
+        case cvk::HostScope::instance: return "instance";
+        case cvk::HostScope::device: return "device";
+        case cvk::HostScope::swapchain: return "swapchain";
+        case cvk::HostScope::pipeline: return "pipeline";
+        case cvk::HostScope::resource: return "resource";
+        }
+        return "?";
+    }
+}
@@ -0,0 +1,72 @@
+/**
+ * @file cge/cvk/host.hpp
+ * @brief Tracked host allocations for `VkAllocationCallbacks`.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <mutex>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace cvk
+{
+    /// The part of the renderer a driver host allocation is attributed to. An object is always created and destroyed under the same scope.
+    enum class HostScope : std::uint32_t
+    {
+        instance, ///< Instance, debug messenger and surface.
+        device, ///< Logical device and command pools.
+        swapchain, ///< Swapchain and per-frame objects, rebuilt by `cvk::remake_swapchain`.
+        pipeline, ///< Render pass, shader modules, layouts, descriptors and pipelines.
+        resource, ///< Buffers, images, samplers and device memory.
+    };
+
+    static inline constexpr std::size_t num_host_scopes{ 5 };
+
+    struct HostCounters
+    {
+        std::size_t   current    ; ///< Bytes currently held by the driver.
+        std::size_t   peak       ; ///< High-water mark of `current`.
+        std::size_t   internal   ; ///< Bytes the driver reports allocating by itself (`pfnInternalAllocation`).
+        std::uint64_t allocations; ///< Number of allocations and reallocations. Compare snapshots to measure churn.
+        std::uint64_t frees      ;
+        std::uint64_t failures   ; ///< Allocations refused because they would exceed `HostAllocator::limit`.
+    };
+
+    struct HostAllocator;
+
+    /// The `pUserData` of each scope's callbacks.
+    struct HostBinding
+    {
+        cvk::HostAllocator* host;
+        cvk::HostScope scope;
+    };
+
+    /**
+     * @brief Pooled allocator that the driver's host allocations are routed through.
+     * @details Small allocations are served from fixed-size slots carved out of 64 KiB chunks, larger ones go straight to the system.
+     */
+    struct HostAllocator
+    {
+        static inline constexpr std::size_t min_slot{ 64 };
+        static inline constexpr std::size_t num_classes{ 7 }; ///< Slots of 64, 128, ..., 4096 bytes.
+        static inline constexpr std::size_t chunk_size{ std::size_t(64) << 10 };
+
+        std::mutex  mutex  ;
+        std::size_t limit  ; ///< Maximum bytes held across all scopes. Zero means unlimited.
+        std::size_t current;
+        std::size_t peak   ;
+        std::size_t pooled ; ///< Bytes reserved by chunks.
+
+        std::array<cvk::HostCounters, num_host_scopes> scopes;
+        std::array<cvk::HostBinding, num_host_scopes> bindings;
+        std::array<VkAllocationCallbacks, num_host_scopes> callbacks; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkAllocationCallbacks.html
+
+        std::array<void*, num_classes> free_slots; ///< Intrusive singly-linked lists of free slots, indexed by size class.
+        std::vector<void*> chunks;
+    };
+}
@@ -0,0 +1,625 @@
+/**
+ * @file cge/cvk/memory.cpp
+ */
+
+#include <algorithm>
+#include <bit>
+
+#include "cvk.hpp"
+
+namespace cvk
+{
+    static VkResult create_heap(cvk::Context& ctx, cvk::Renderable& gfx, cvk::Offset memtype, cvk::Strategy strategy, VkDeviceSize capacity, bool dedicated, cvk::Offset& heap_idx) noexcept;
+    static void destroy_heap(cvk::Context& ctx, cvk::Renderable& gfx, cvk::Offset heap_idx) noexcept;
+    static bool heap_alloc(cvk::Heap& heap, VkDeviceSize size, VkDeviceSize align, cvk::Allocation& alloc) noexcept;
+    static void heap_free(cvk::Heap& heap, const cvk::Allocation& alloc) noexcept;
+    static constexpr const char* strategy_name(cvk::Strategy strategy) noexcept;
+    static constexpr VkDeviceSize align_up(VkDeviceSize value, VkDeviceSize align) noexcept;
+
+    static bool linear_alloc(cvk::Heap& heap, VkDeviceSize size, VkDeviceSize align, VkDeviceSize& offset) noexcept;
+    static void linear_free(cvk::Heap& heap) noexcept;
+
+    static void buddy_init(cvk::Heap& heap) noexcept;
+    static bool buddy_alloc(cvk::Heap& heap, VkDeviceSize size, VkDeviceSize align, VkDeviceSize& offset, std::uint32_t& order) noexcept;
+    static void buddy_free(cvk::Heap& heap, VkDeviceSize offset, std::uint32_t order) noexcept;
+
+    static void tlsf_init(cvk::Heap& heap) noexcept;
+    static bool tlsf_alloc(cvk::Heap& heap, VkDeviceSize size, VkDeviceSize align, VkDeviceSize& offset, std::uint32_t& block_idx) noexcept;
+    static void tlsf_free(cvk::Heap& heap, std::uint32_t block_idx) noexcept;
+    static void tlsf_mapping(VkDeviceSize size, std::uint32_t& fl, std::uint32_t& sl) noexcept;
+    static std::uint32_t tlsf_find(const cvk::Heap& heap, std::uint32_t fl, std::uint32_t sl) noexcept;
+    static void tlsf_insert(cvk::Heap& heap, std::uint32_t block_idx) noexcept;
+    static void tlsf_remove(cvk::Heap& heap, std::uint32_t block_idx) noexcept;
+    static std::uint32_t tlsf_split(cvk::Heap& heap, std::uint32_t block_idx, VkDeviceSize first_size) noexcept;
+    static void tlsf_release(cvk::Heap& heap, std::uint32_t block_idx) noexcept;
+}
+
+namespace cvk
+{
+    VkResult allocate_memory(cvk::Context& ctx, cvk::Renderable& gfx, const VkMemoryRequirements& reqs, const VkMemoryPropertyFlags props, const cvk::Strategy strategy, cvk::Allocation& alloc) noexcept
+    {
+        const VkPhysicalDeviceMemoryProperties& mem_props{ ctx.device_memory[gfx.sel_device] };
+        const VkPhysicalDeviceLimits& limits{ ctx.device_properties[gfx.sel_device].limits };
+
+        // Buffers and optimal-tiling images may share a heap, so keep them `bufferImageGranularity` apart.
+        const VkDeviceSize align{ std::max({ reqs.alignment, limits.bufferImageGranularity, cvk::heap_granularity }) };
+        const VkDeviceSize size{ cvk::align_up(reqs.size, cvk::heap_granularity) };
+
+        for (cvk::Offset memtype{}; memtype < mem_props.memoryTypeCount; ++memtype)
+        {
+            const cvk::Offset this_bit{ static_cast<cvk::Offset>(1) << memtype };
+            if ((reqs.memoryTypeBits & this_bit) == 0) continue;
+            if ((mem_props.memoryTypes[memtype].propertyFlags & props) != props) continue;
+
+            for (cvk::Offset heap_idx{}; heap_idx < static_cast<cvk::Offset>(gfx.heaps.size()); ++heap_idx)
+            {
+                cvk::Heap& heap{ gfx.heaps[heap_idx] };
+                if (!heap.memory || heap.dedicated) continue;
+                if ((heap.memtype != memtype) || (heap.strategy != strategy)) continue;
+
+                if (cvk::heap_alloc(heap, size, align, alloc))
+                {
+                    alloc.heap = heap_idx;
+                    return VK_SUCCESS;
+                }
+            }
+
+            // Keep blocks small relative to the heap they come from, so one block cannot exhaust it.
+            const VkMemoryHeap& mem_heap{ mem_props.memoryHeaps[mem_props.memoryTypes[memtype].heapIndex] };
+            const VkDeviceSize block_size{ std::max(std::bit_floor(std::min(cvk::heap_block_size, mem_heap.size / 8)), cvk::heap_granularity) };
+            const bool dedicated{ size + align > block_size / 2 };
+            const VkDeviceSize capacity{ dedicated ? size : block_size };
+
+            cvk::Offset heap_idx{};
+            const VkResult res_heap{ cvk::create_heap(ctx, gfx, memtype, dedicated ? cvk::Strategy::linear : strategy, capacity, dedicated, heap_idx) };
+            if (res_heap != VK_SUCCESS) continue;
+
+            const bool res_alloc{ cvk::heap_alloc(gfx.heaps[heap_idx], size, align, alloc) };
+            CGE_ASSERT(res_alloc);
+            alloc.heap = heap_idx;
+            return VK_SUCCESS;
+        }
+
+        return VK_ERROR_OUT_OF_DEVICE_MEMORY;
+    }
+
+    void free_memory(cvk::Context& ctx, cvk::Renderable& gfx, cvk::Allocation& alloc) noexcept
+    {
+        if (!alloc.memory) return;
+
+        CGE_ASSERT(alloc.heap < gfx.heaps.size());
+        cvk::Heap& heap{ gfx.heaps[alloc.heap] };
+        CGE_ASSERT(heap.memory == alloc.memory);
+
+        cvk::heap_free(heap, alloc);
+
+        if (heap.allocations == 0)
+        {
+            // Dedicated heaps hold one allocation, and linear heaps hold short-lived staging memory, so both are released as soon as they are empty.
+            // Other heaps keep one empty spare per memory type and strategy, so that freeing and reallocating (as on a resize) does not go back to the driver.
+            const auto is_spare = [&](const cvk::Heap& other) {
+                return other.memory && (other.memory != heap.memory) && !other.dedicated && (other.allocations == 0) && (other.memtype == heap.memtype) && (other.strategy == heap.strategy);
+            };
+            const bool keep{ !heap.dedicated && (heap.strategy != cvk::Strategy::linear) && std::ranges::none_of(gfx.heaps, is_spare) };
+            if (!keep) cvk::destroy_heap(ctx, gfx, alloc.heap);
+        }
+
+        alloc = {};
+    }
+
+    VkResult flush_memory(cvk::Context& ctx, cvk::Renderable& gfx, const cvk::Allocation& alloc, const VkDeviceSize offset, const VkDeviceSize size) noexcept
+    {
+        if (!alloc.memory || (size == 0)) return VK_SUCCESS;
+
+        const cvk::Heap& heap{ gfx.heaps[alloc.heap] };
+        const VkPhysicalDeviceMemoryProperties& mem_props{ ctx.device_memory[gfx.sel_device] };
+        if (mem_props.memoryTypes[heap.memtype].propertyFlags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT) return VK_SUCCESS;
+
+        // Flushed ranges must cover whole atoms, or end at the end of the memory object.
+        const VkDeviceSize atom{ ctx.device_properties[gfx.sel_device].limits.nonCoherentAtomSize };
+        const VkDeviceSize beg{ ((alloc.offset + offset) / atom) * atom };
+        const VkDeviceSize end{ std::min(cvk::align_up(alloc.offset + offset + size, atom), heap.capacity) };
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkMappedMemoryRange.html
+        const VkMappedMemoryRange range{
+            .sType = VK_STRUCTURE_TYPE_MAPPED_MEMORY_RANGE,
+            .pNext = {},
+            .memory = alloc.memory,
+            .offset = beg,
+            .size = end - beg,
+        };
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkFlushMappedMemoryRanges.html
+        return vkFlushMappedMemoryRanges(gfx.device, 1, &range);
+    }
+
+    void deinit_memory(cvk::Context& ctx, cvk::Renderable& gfx) noexcept
+    {
+    #if defined(CGE_DEBUG)
+        cvk::log_memory(gfx);
+    #endif
+
+        for (cvk::Offset heap_idx{}; heap_idx < static_cast<cvk::Offset>(gfx.heaps.size()); ++heap_idx)
+        {
+            cvk::destroy_heap(ctx, gfx, heap_idx);
+        }
+        gfx.heaps.clear();
+    }
+
+    cvk::HeapStats memory_stats(const cvk::Renderable& gfx, const cvk::Offset heap_idx) noexcept
+    {
+        const cvk::Heap& heap{ gfx.heaps[heap_idx] };
+
+        VkDeviceSize total_free{};
+        VkDeviceSize largest_free{};
+
+        switch (heap.strategy)
+        {
+        case cvk::Strategy::linear:
+            total_free = heap.capacity - heap.linear_head;
+            largest_free = total_free;
+            break;
+
+        case cvk::Strategy::buddy:
+            for (std::size_t order{}; order < heap.buddy_free.size(); ++order)
+            {
+                const VkDeviceSize block{ cvk::heap_granularity << order };
+                total_free += block * heap.buddy_free[order].size();
+                if (!heap.buddy_free[order].empty()) largest_free = block;
+            }
+            break;
+
+        case cvk::Strategy::tlsf:
+            for (const cvk::TlsfBlock& block : heap.tlsf_blocks)
+            {
+                if (!block.free) continue;
+                total_free += block.size;
+                largest_free = std::max(largest_free, block.size);
+            }
+            break;
+        }
+
+        return cvk::HeapStats{
+            .memtype = heap.memtype,
+            .strategy = heap.strategy,
+            .capacity = heap.capacity,
+            .used = heap.used,
+            .free = total_free,
+            .largest_free = largest_free,
+            .allocations = heap.allocations,
+            .fragmentation = (total_free > 0) ? 1.0 - double(largest_free) / double(total_free) : 0.0,
+        };
+    }
+
+    void log_memory(const cvk::Renderable& gfx [[maybe_unused]]) noexcept
+    {
+    #if defined(CGE_DEBUG)
+        for (cvk::Offset heap_idx{}; heap_idx < static_cast<cvk::Offset>(gfx.heaps.size()); ++heap_idx)
+        {
+            if (!gfx.heaps[heap_idx].memory) continue;
+
+            const cvk::HeapStats stats{ cvk::memory_stats(gfx, heap_idx) };
+            CGE_LOG("[CGE] Heap {:2}: type {:2} | {:6} | used {:10} | free {:10} / {:10} | {:4} allocs | {:5.1f}% fragmented\n",
+                heap_idx, stats.memtype, cvk::strategy_name(stats.strategy),
+                stats.used, stats.free, stats.capacity, stats.allocations, stats.fragmentation * 100.0
+            );
+        }
+    #endif
+    }
+}
+
+namespace cvk
+{
+    VkResult create_heap(cvk::Context& ctx, cvk::Renderable& gfx, const cvk::Offset memtype, const cvk::Strategy strategy, const VkDeviceSize capacity, const bool dedicated, cvk::Offset& heap_idx) noexcept
+    {
+        const auto reuse{ std::ranges::find(gfx.heaps, VkDeviceMemory{}, &cvk::Heap::memory) };
+        heap_idx = static_cast<cvk::Offset>(reuse - gfx.heaps.begin());
+        if (reuse == gfx.heaps.end()) gfx.heaps.emplace_back();
+
+        cvk::Heap& heap{ gfx.heaps[heap_idx] };
+        heap = cvk::Heap{};
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkMemoryAllocateInfo.html
+        const VkMemoryAllocateInfo alloc_info{
+            .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+            .pNext = {},
+            .allocationSize = capacity,
+            .memoryTypeIndex = memtype,
+        };
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkAllocateMemory.html
+        const VkResult res_alloc{ vkAllocateMemory(gfx.device, &alloc_info, cvk::allocator(ctx, cvk::HostScope::resource), &heap.memory) };
+        if (res_alloc != VK_SUCCESS)
+        {
+            heap.memory = {};
+            return res_alloc;
+        }
+
+        const VkPhysicalDeviceMemoryProperties& mem_props{ ctx.device_memory[gfx.sel_device] };
+        if (mem_props.memoryTypes[memtype].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)
+        {
+            // A `VkDeviceMemory` can only be mapped once, so the heap owns one persistent mapping.
+
+            // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkMapMemory.html
+            const VkResult res_map{ vkMapMemory(gfx.device, heap.memory, 0, VK_WHOLE_SIZE, 0, &heap.mapped) };
+            if (res_map != VK_SUCCESS)
+            {
+                // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkFreeMemory.html
+                vkFreeMemory(gfx.device, heap.memory, cvk::allocator(ctx, cvk::HostScope::resource));
+                heap = cvk::Heap{};
+                return res_map;
+            }
+        }
+
+        heap.capacity = capacity;
+        heap.memtype = memtype;
+        heap.strategy = strategy;
+        heap.dedicated = dedicated;
+
+        switch (strategy)
+        {
+        case cvk::Strategy::linear: break;
+        case cvk::Strategy::buddy: cvk::buddy_init(heap); break;
+        case cvk::Strategy::tlsf: cvk::tlsf_init(heap); break;
+        }
+
+        CGE_LOG("[CGE] Heap {} created: type {}, {}, {} bytes{}\n", heap_idx, memtype, cvk::strategy_name(strategy), capacity, dedicated ? " (dedicated)" : "");
+        return VK_SUCCESS;
+    }
+
+    void destroy_heap(cvk::Context& ctx [[maybe_unused]], cvk::Renderable& gfx, const cvk::Offset heap_idx) noexcept
+    {
+        cvk::Heap& heap{ gfx.heaps[heap_idx] };
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkUnmapMemory.html
+        if (heap.mapped)
+            vkUnmapMemory(gfx.device, heap.memory);
+
+        // https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/vkFreeMemory.html
+        if (heap.memory)
+            vkFreeMemory(gfx.device, heap.memory, cvk::allocator(ctx, cvk::HostScope::resource));
+
+        heap = cvk::Heap{};
+    }
+
+    bool heap_alloc(cvk::Heap& heap, const VkDeviceSize size, const VkDeviceSize align, cvk::Allocation& alloc) noexcept
+    {
+        VkDeviceSize offset{};
+        VkDeviceSize consumed{ size };
+        std::uint32_t handle{};
+
+        switch (heap.strategy)
+        {
+        case cvk::Strategy::linear:
+            if (!cvk::linear_alloc(heap, size, align, offset)) return false;
+            break;
+
+        case cvk::Strategy::buddy:
+            if (!cvk::buddy_alloc(heap, size, align, offset, handle)) return false;
+            consumed = cvk::heap_granularity << handle;
+            break;
+
+        case cvk::Strategy::tlsf:
+            if (!cvk::tlsf_alloc(heap, size, align, offset, handle)) return false;
+            consumed = heap.tlsf_blocks[handle].size;
+            break;
+        }
+
+        heap.used += consumed;
+        heap.allocations += 1;
+
+        alloc = cvk::Allocation{
+            .memory = heap.memory,
+            .offset = offset,
+            .size = consumed,
+            .mapped = heap.mapped ? static_cast<void*>(static_cast<std::byte*>(heap.mapped) + offset) : nullptr,
+            .heap = {},
+            .handle = handle,
+        };
+        return true;
+    }
+
+    void heap_free(cvk::Heap& heap, const cvk::Allocation& alloc) noexcept
+    {
+        CGE_ASSERT(heap.allocations > 0);
+        heap.used -= alloc.size;
+        heap.allocations -= 1;
+
+        switch (heap.strategy)
+        {
+        case cvk::Strategy::linear: cvk::linear_free(heap); break;
+        case cvk::Strategy::buddy: cvk::buddy_free(heap, alloc.offset, alloc.handle); break;
+        case cvk::Strategy::tlsf: cvk::tlsf_free(heap, alloc.handle); break;
+        }
+    }
+
+    constexpr const char* strategy_name(const cvk::Strategy strategy) noexcept
+    {
+        switch (strategy)
+        {
+        case cvk::Strategy::linear: return "linear";
+        case cvk::Strategy::buddy: return "buddy";
+        case cvk::Strategy::tlsf: return "tlsf";
+        }
+        return "?";
+    }
+
+    constexpr VkDeviceSize align_up(const VkDeviceSize value, const VkDeviceSize align) noexcept
+    {
+        return ((value + align - 1) / align) * align;
+    }
+}
+
+namespace cvk
+{
+    bool linear_alloc(cvk::Heap& heap, const VkDeviceSize size, const VkDeviceSize align, VkDeviceSize& offset) noexcept
+    {
+        const VkDeviceSize base{ cvk::align_up(heap.linear_head, align) };
+        if (base + size > heap.capacity) return false;
+
+        heap.linear_head = base + size;
+        offset = base;
+        return true;
+    }
+
+    void linear_free(cvk::Heap& heap) noexcept
+    {
+        if (heap.allocations == 0) heap.linear_head = 0;
+    }
+}
+
+namespace cvk
+{
+    void buddy_init(cvk::Heap& heap) noexcept
+    {
+        CGE_ASSERT(std::has_single_bit(heap.capacity / cvk::heap_granularity));
+        const std::uint32_t max_order{ static_cast<std::uint32_t>(std::countr_zero(heap.capacity / cvk::heap_granularity)) };
+
+        heap.buddy_free.resize(max_order + 1);
+        heap.buddy_free[max_order].push_back(0);
+    }
+
+    bool buddy_alloc(cvk::Heap& heap, const VkDeviceSize size, const VkDeviceSize align, VkDeviceSize& offset, std::uint32_t& order) noexcept
+    {
+        // Blocks are naturally aligned to their own size.
+        const VkDeviceSize block{ std::bit_ceil(std::max(size, align)) };
+        order = static_cast<std::uint32_t>(std::countr_zero(block / cvk::heap_granularity));
+        if (order >= heap.buddy_free.size()) return false;
+
+        std::uint32_t avail{ order };
+        while ((avail < heap.buddy_free.size()) && heap.buddy_free[avail].empty()) ++avail;
+        if (avail >= heap.buddy_free.size()) return false;
+
+        offset = heap.buddy_free[avail].back();
+        heap.buddy_free[avail].pop_back();
+
+        while (avail > order)
+        {
+            --avail;
+            heap.buddy_free[avail].push_back(offset + (cvk::heap_granularity << avail));
+        }
+        return true;
+    }
+
+    void buddy_free(cvk::Heap& heap, VkDeviceSize offset, std::uint32_t order) noexcept
+    {
+        while (order + 1 < heap.buddy_free.size())
+        {
+            std::vector<VkDeviceSize>& list{ heap.buddy_free[order] };
+            const VkDeviceSize buddy{ offset ^ (cvk::heap_granularity << order) };
+
+            const auto found{ std::ranges::find(list, buddy) };
+            if (found == list.end()) break;
+
+            *found = list.back();
+            list.pop_back();
+
+            offset = std::min(offset, buddy);
+            ++order;
+        }
+        heap.buddy_free[order].push_back(offset);
+    }
+}
+
+namespace cvk
+{
+    void tlsf_init(cvk::Heap& heap) noexcept
+    {
+        for (auto& heads : heap.tlsf_heads) heads.fill(cvk::null_idx);
+        heap.tlsf_sl_bitmap.fill(0);
+        heap.tlsf_fl_bitmap = 0;
+
+        heap.tlsf_blocks.push_back(cvk::TlsfBlock{
+            .offset = 0,
+            .size = heap.capacity,
+            .prev_phys = cvk::null_idx,
+            .next_phys = cvk::null_idx,
+            .prev_free = cvk::null_idx,
+            .next_free = cvk::null_idx,
+            .free = false,
+        });
+        cvk::tlsf_insert(heap, 0);
+    }
+
+    bool tlsf_alloc(cvk::Heap& heap, const VkDeviceSize size, const VkDeviceSize align, VkDeviceSize& offset, std::uint32_t& block_idx) noexcept
+    {
+        // Over-allocate by the extra alignment, so any block found can be aligned by splitting off its front.
+        const VkDeviceSize search{ size + (align - cvk::heap_granularity) };
+
+        // Round up to the next size class, so every block in the class found is large enough.
+        std::uint32_t fl{};
+        std::uint32_t sl{};
+        cvk::tlsf_mapping(search, fl, sl);
+        const VkDeviceSize rounded{ (fl == 0) ? search : search + (cvk::heap_granularity << (fl - 1)) - cvk::heap_granularity };
+        cvk::tlsf_mapping(rounded, fl, sl);
+        if (fl >= cvk::Heap::tlsf_fl_count) return false;
+
+        block_idx = cvk::tlsf_find(heap, fl, sl);
+        if (block_idx == cvk::null_idx) return false;
+        cvk::tlsf_remove(heap, block_idx);
+
+        const VkDeviceSize aligned{ cvk::align_up(heap.tlsf_blocks[block_idx].offset, align) };
+        const VkDeviceSize padding{ aligned - heap.tlsf_blocks[block_idx].offset };
+        if (padding > 0)
+        {
+            const std::uint32_t rest{ cvk::tlsf_split(heap, block_idx, padding) };
+            cvk::tlsf_insert(heap, block_idx);
+            block_idx = rest;
+        }
+
+        if (heap.tlsf_blocks[block_idx].size > size)
+        {
+            const std::uint32_t rest{ cvk::tlsf_split(heap, block_idx, size) };
+            cvk::tlsf_insert(heap, rest);
+        }
+
+        offset = heap.tlsf_blocks[block_idx].offset;
+        return true;
+    }
+
+    void tlsf_free(cvk::Heap& heap, std::uint32_t block_idx) noexcept
+    {
+        const std::uint32_t prev{ heap.tlsf_blocks[block_idx].prev_phys };
+        if ((prev != cvk::null_idx) && heap.tlsf_blocks[prev].free)
+        {
+            cvk::tlsf_remove(heap, prev);
+            heap.tlsf_blocks[prev].size += heap.tlsf_blocks[block_idx].size;
+            heap.tlsf_blocks[prev].next_phys = heap.tlsf_blocks[block_idx].next_phys;
+            if (heap.tlsf_blocks[prev].next_phys != cvk::null_idx)
+                heap.tlsf_blocks[heap.tlsf_blocks[prev].next_phys].prev_phys = prev;
+            cvk::tlsf_release(heap, block_idx);
+            block_idx = prev;
+        }
+
+        const std::uint32_t next{ heap.tlsf_blocks[block_idx].next_phys };
+        if ((next != cvk::null_idx) && heap.tlsf_blocks[next].free)
+        {
+            cvk::tlsf_remove(heap, next);
+            heap.tlsf_blocks[block_idx].size += heap.tlsf_blocks[next].size;
+            heap.tlsf_blocks[block_idx].next_phys = heap.tlsf_blocks[next].next_phys;
+            if (heap.tlsf_blocks[block_idx].next_phys != cvk::null_idx)
+                heap.tlsf_blocks[heap.tlsf_blocks[block_idx].next_phys].prev_phys = block_idx;
+            cvk::tlsf_release(heap, next);
+        }
+
+        cvk::tlsf_insert(heap, block_idx);
+    }
+
+    void tlsf_mapping(const VkDeviceSize size, std::uint32_t& fl, std::uint32_t& sl) noexcept
+    {
+        // First level: power-of-two range. Second level: linear subdivision of that range.
+        const VkDeviceSize units{ size / cvk::heap_granularity };
+        if (units < cvk::Heap::tlsf_sl_count)
+        {
+            fl = 0;
+            sl = static_cast<std::uint32_t>(units);
+        }
+        else
+        {
+            fl = static_cast<std::uint32_t>(std::bit_width(units)) - cvk::Heap::tlsf_sl_log2;
+            sl = static_cast<std::uint32_t>(units >> (fl - 1)) - cvk::Heap::tlsf_sl_count;
+        }
+    }
+
+    std::uint32_t tlsf_find(const cvk::Heap& heap, std::uint32_t fl, std::uint32_t sl) noexcept
+    {
+        std::uint32_t sl_map{ heap.tlsf_sl_bitmap[fl] & (~std::uint32_t{} << sl) };
+        if (sl_map == 0)
+        {
+            const std::uint64_t fl_map{ (fl + 1 < 64) ? (heap.tlsf_fl_bitmap & (~std::uint64_t{} << (fl + 1))) : 0 };
+            if (fl_map == 0) return cvk::null_idx;
+
+            fl = static_cast<std::uint32_t>(std::countr_zero(fl_map));
+            sl_map = heap.tlsf_sl_bitmap[fl];
+        }
+        sl = static_cast<std::uint32_t>(std::countr_zero(sl_map));
+        return heap.tlsf_heads[fl][sl];
+    }
+
+    void tlsf_insert(cvk::Heap& heap, const std::uint32_t block_idx) noexcept
+    {
+        std::uint32_t fl{};
+        std::uint32_t sl{};
+        cvk::tlsf_mapping(heap.tlsf_blocks[block_idx].size, fl, sl);
+        CGE_ASSERT(fl < cvk::Heap::tlsf_fl_count);
+
+        std::uint32_t& head{ heap.tlsf_heads[fl][sl] };
+        cvk::TlsfBlock& block{ heap.tlsf_blocks[block_idx] };
+        block.free = true;
+        block.prev_free = cvk::null_idx;
+        block.next_free = head;
+        if (head != cvk::null_idx) heap.tlsf_blocks[head].prev_free = block_idx;
+        head = block_idx;
+
+        heap.tlsf_sl_bitmap[fl] |= std::uint32_t(1) << sl;
+        heap.tlsf_fl_bitmap |= std::uint64_t(1) << fl;
+    }
+
+    void tlsf_remove(cvk::Heap& heap, const std::uint32_t block_idx) noexcept
+    {
+        std::uint32_t fl{};
+        std::uint32_t sl{};
+        cvk::tlsf_mapping(heap.tlsf_blocks[block_idx].size, fl, sl);
+
+        cvk::TlsfBlock& block{ heap.tlsf_blocks[block_idx] };
+        if (block.prev_free != cvk::null_idx) heap.tlsf_blocks[block.prev_free].next_free = block.next_free;
+        if (block.next_free != cvk::null_idx) heap.tlsf_blocks[block.next_free].prev_free = block.prev_free;
+
+        std::uint32_t& head{ heap.tlsf_heads[fl][sl] };
+        if (head == block_idx) head = block.next_free;
+        if (head == cvk::null_idx)
+        {
+            heap.tlsf_sl_bitmap[fl] &= ~(std::uint32_t(1) << sl);
+            if (heap.tlsf_sl_bitmap[fl] == 0) heap.tlsf_fl_bitmap &= ~(std::uint64_t(1) << fl);
+        }
+
+        block.free = false;
+        block.prev_free = cvk::null_idx;
+        block.next_free = cvk::null_idx;
+    }
+
+    std::uint32_t tlsf_split(cvk::Heap& heap, const std::uint32_t block_idx, const VkDeviceSize first_size) noexcept
+    {
+        std::uint32_t rest_idx{};
+        if (heap.tlsf_spare.empty())
+        {
+            rest_idx = static_cast<std::uint32_t>(heap.tlsf_blocks.size());
+            heap.tlsf_blocks.emplace_back();
+        }
+        else
+        {
+            rest_idx = heap.tlsf_spare.back();
+            heap.tlsf_spare.pop_back();
+        }
+
+        cvk::TlsfBlock& block{ heap.tlsf_blocks[block_idx] };
+        CGE_ASSERT(first_size < block.size);
+
+        heap.tlsf_blocks[rest_idx] = cvk::TlsfBlock{
+            .offset = block.offset + first_size,
+            .size = block.size - first_size,
+            .prev_phys = block_idx,
+            .next_phys = block.next_phys,
+            .prev_free = cvk::null_idx,
+            .next_free = cvk::null_idx,
+            .free = false,
+        };
+        if (block.next_phys != cvk::null_idx) heap.tlsf_blocks[block.next_phys].prev_phys = rest_idx;
+        block.next_phys = rest_idx;
+        block.size = first_size;
+
+        return rest_idx;
+    }
+
+    void tlsf_release(cvk::Heap& heap, const std::uint32_t block_idx) noexcept
+    {
+        heap.tlsf_blocks[block_idx] = cvk::TlsfBlock{
+            .offset = {},
+            .size = {},
+            .prev_phys = cvk::null_idx,
+            .next_phys = cvk::null_idx,
+            .prev_free = cvk::null_idx,
+            .next_free = cvk::null_idx,
+            .free = false,
+        };
+        heap.tlsf_spare.push_back(block_idx);
+    }
+}
@@ -0,0 +1,89 @@
+/**
+ * @file cge/cvk/memory.hpp
+ * @brief Sub-allocation of `VkDeviceMemory` blocks.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <vector>
+
+#include <vulkan/vulkan.h>
+
+namespace cvk
+{
+    enum class Strategy
+    {
+        linear, ///< Bump allocator. Space is only reclaimed once every allocation in the heap has been freed.
+        buddy, ///< Power-of-two blocks, split and merged with their buddy. Fast, but rounds sizes up.
+        tlsf, ///< Two-Level Segregated Fit. O(1) general-purpose allocation with immediate coalescing.
+    };
+
+    /// A range of a heap's `VkDeviceMemory`. A null `memory` means nothing is allocated.
+    struct Allocation
+    {
+        VkDeviceMemory memory; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDeviceMemory.html
+        VkDeviceSize   offset; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDeviceSize.html
+        VkDeviceSize   size  ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDeviceSize.html
+        void*          mapped; ///< Host pointer to `offset`, if the heap is host-visible.
+        std::uint32_t  heap  ;
+        std::uint32_t  handle; ///< Strategy-specific bookkeeping (buddy order, TLSF block index).
+    };
+
+    struct HeapStats
+    {
+        std::uint32_t memtype;
+        cvk::Strategy strategy;
+        VkDeviceSize  capacity;
+        VkDeviceSize  used;
+        VkDeviceSize  free;
+        VkDeviceSize  largest_free;
+        std::uint32_t allocations;
+        double        fragmentation; ///< `1 - largest_free / free`. It is 0 when all free space is contiguous.
+    };
+
+    struct TlsfBlock
+    {
+        VkDeviceSize  offset;
+        VkDeviceSize  size;
+        std::uint32_t prev_phys;
+        std::uint32_t next_phys;
+        std::uint32_t prev_free;
+        std::uint32_t next_free;
+        bool          free;
+    };
+
+    struct Heap
+    {
+        static inline constexpr std::uint32_t tlsf_sl_log2{ 4 };
+        static inline constexpr std::uint32_t tlsf_sl_count{ 1 << tlsf_sl_log2 };
+        static inline constexpr std::uint32_t tlsf_fl_count{ 48 };
+
+        VkDeviceMemory memory   ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDeviceMemory.html
+        VkDeviceSize   capacity ; ///< https://registry.khronos.org/vulkan/specs/1.3-extensions/man/html/VkDeviceSize.html
+        void*          mapped   ;
+        std::uint32_t  memtype  ;
+        cvk::Strategy  strategy ;
+        bool           dedicated; ///< Holds a single oversized allocation and is released with it.
+
+        VkDeviceSize  used       ;
+        std::uint32_t allocations;
+
+        VkDeviceSize linear_head;
+
+        std::vector<std::vector<VkDeviceSize>> buddy_free; ///< Free block offsets, indexed by order.
+
+        std::vector<cvk::TlsfBlock> tlsf_blocks;
+        std::vector<std::uint32_t>  tlsf_spare ;
+        std::uint64_t               tlsf_fl_bitmap;
+        std::array<std::uint32_t, tlsf_fl_count> tlsf_sl_bitmap;
+        std::array<std::array<std::uint32_t, tlsf_sl_count>, tlsf_fl_count> tlsf_heads;
+    };
+
+    /// Size of the `VkDeviceMemory` blocks that heaps are carved from.
+    static inline constexpr VkDeviceSize heap_block_size{ VkDeviceSize(64) << 20 };
+
+    /// Every sub-allocation is aligned to (and rounded up to) this many bytes.
+    static inline constexpr VkDeviceSize heap_granularity{ 256 };
+}
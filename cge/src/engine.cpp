@@ -11,7 +11,9 @@ namespace cge
     void Game::render([[maybe_unused]] cge::Engine& engine, [[maybe_unused]] cge::Scene& scene) {}
     
     void Renderer::target_window([[maybe_unused]] cge::Engine& engine, [[maybe_unused]] wyn_window_t window) {}
-    void Renderer::render([[maybe_unused]] cge::Engine& engine) {}
+    void Renderer::prepare([[maybe_unused]] cge::Engine& engine) {}
+    void Renderer::render([[maybe_unused]] cge::Engine& engine, [[maybe_unused]] cge::Scene& scene) {}
+    bool Renderer::current([[maybe_unused]] cge::Engine& engine) { return false; }
 }
 
 namespace cge
@@ -135,6 +137,140 @@ namespace cge
     {
         return double(wyt_nanotime() - engine.epoch) / 1'000'000'000.0;
     }
+
+    double tick_alpha(const cge::Engine& engine) noexcept
+    {
+        if (!engine.tick_nanos) return 1.0;
+
+        const wyt_utime_t now{ wyt_nanotime() };
+        if (now <= engine.last_tick) return 0.0;
+
+        return std::min(double(now - engine.last_tick) / double(engine.tick_nanos), 1.0);
+    }
+}
+
+namespace cge
+{
+    /// Hands the frame the game just built to the render thread, replacing any frame it has not taken yet.
+    static void publish_frame(cge::Engine& engine)
+    {
+        engine.scene.hand_off(engine.frames[engine.frame_back]);
+
+        // Acquire, so this thread sees everything the renderer did with the frame it hands back.
+        const std::uint8_t prev{ engine.mailbox.exchange(engine.frame_back | cge::mailbox_fresh, std::memory_order::acq_rel) };
+        engine.frame_back = prev & cge::mailbox_slot;
+    }
+
+    static void run_callbacks(cge::Engine& engine, const cge::Signal signal)
+    {
+        if (signal & cge::signal_render)
+        {
+            engine.game.render(engine, engine.scene);
+            if (engine.triple_buffer) cge::publish_frame(engine);
+            engine.cached_vsync = engine.settings.vsync;
+            engine.cached_zero_copy = engine.settings.zero_copy;
+            engine.cached_skip_unchanged = engine.settings.skip_unchanged;
+        }
+
+        if (signal & cge::signal_update)
+        {
+            engine.last_tick = engine.pending_tick;
+            engine.tick_nanos = engine.pending_nanos;
+            engine.game.update(engine);
+            engine.cached_fps = engine.settings.fps;
+            engine.cached_max_catch_up = engine.settings.max_catch_up;
+        }
+    }
+
+    /// Converts a cursor position in window units, within a window of `content`, to the Scene's normalized coordinates.
+    static cge::EventCursor normalize_cursor(const cge::Scene& scene, const wyn_extent_t content, const cge::EventCursor cursor) noexcept
+    {
+        const cge::Viewport view{
+            cge::viewport(
+                cge::uint(content.w), cge::uint(content.h),
+                cge::uint(scene.res_w), cge::uint(scene.res_h),
+                scene.scaling
+            )
+        };
+
+        const wyn_coord_t rel_x{ wyn_coord_t(cursor.x) - wyn_coord_t(view.x) };
+        const wyn_coord_t rel_y{ wyn_coord_t(cursor.y) - wyn_coord_t(view.y) };
+        const wyn_coord_t nrm_x{ (rel_x / wyn_coord_t(view.w)) * 2 - 1 };
+        const wyn_coord_t nrm_y{ (rel_y / wyn_coord_t(view.h)) * 2 - 1 };
+
+        return cge::EventCursor{ nrm_x, nrm_y };
+    }
+
+    /// Passes `event` to the game, or queues it for the game thread. An `EventCursor` is in window units, within a window of `content`.
+    static void send_event(cge::Engine& engine, cge::Event event, const wyn_extent_t content = {})
+    {
+        if (!engine.worker_callbacks)
+        {
+            if (cge::EventCursor* const cursor{ std::get_if<cge::EventCursor>(&event) }) *cursor = cge::normalize_cursor(engine.scene, content, *cursor);
+            engine.game.event(engine, event);
+            return;
+        }
+
+        {
+            const std::scoped_lock lock{ engine.event_mutex };
+
+            // The text only lives as long as this callback, so it is copied.
+            std::size_t text{};
+            if (const cge::EventText* const str{ std::get_if<cge::EventText>(&event) })
+            {
+                const std::size_t len{ std::strlen(reinterpret_cast<const char*>(str->text)) };
+                text = engine.event_text.size();
+                engine.event_text.insert(engine.event_text.end(), str->text, str->text + len + 1);
+            }
+
+            engine.events.push_back(cge::QueuedEvent{ .event = event, .text = text, .content = content });
+        }
+
+        (void)engine.signal.fetch_or(cge::signal_event, std::memory_order::relaxed);
+        engine.signal.notify_all();
+    }
+
+    /// Passes the events queued by `send_event` to the game. `events` and `text` are the game thread's, swapped with the queue.
+    static void deliver_events(cge::Engine& engine, std::vector<cge::QueuedEvent>& events, std::vector<unsigned char>& text)
+    {
+        (void)engine.signal.fetch_and(cge::Signal(~cge::signal_event), std::memory_order::relaxed);
+
+        {
+            const std::scoped_lock lock{ engine.event_mutex };
+            std::swap(events, engine.events);
+            std::swap(text, engine.event_text);
+        }
+
+        for (cge::QueuedEvent& queued : events)
+        {
+            if (cge::EventText* const str{ std::get_if<cge::EventText>(&queued.event) }) str->text = text.data() + queued.text;
+            if (cge::EventCursor* const cursor{ std::get_if<cge::EventCursor>(&queued.event) }) *cursor = cge::normalize_cursor(engine.scene, queued.content, *cursor);
+            engine.game.event(engine, queued.event);
+        }
+
+        events.clear();
+        text.clear();
+    }
+
+    /// Applies the window changes requested by the game thread.
+    static void apply_window(cge::Engine& engine)
+    {
+        (void)engine.signal.fetch_and(cge::Signal(~cge::signal_window), std::memory_order::relaxed);
+
+        const std::scoped_lock lock{ engine.window_mutex };
+        const cge::WindowState& request{ engine.window_request };
+
+        const wyn_rect_t old_rect{ wyn_window_position(engine.window) };
+        const wyn_bool_t old_fs{ wyn_window_is_fullscreen(engine.window) };
+        const wyn_extent_t new_extent{ .w = request.width, .h = request.height };
+
+        if ((old_rect.extent.w != new_extent.w) || (old_rect.extent.h != new_extent.h)) wyn_window_reposition(engine.window, nullptr, &new_extent);
+        if (old_fs != request.fullscreen) wyn_window_fullscreen(engine.window, request.fullscreen);
+        if (engine.window_state.name != request.name) wyn_window_retitle(engine.window, reinterpret_cast<const wyn_utf8_t*>(request.name));
+
+        // The position and fullscreen state may only change later, which `wyn_on_window_reposition` picks up.
+        engine.window_state.name = request.name;
+    }
 }
 
 extern "C"
@@ -168,11 +304,32 @@ extern "C"
             wyn_window_fullscreen(engine.window, engine.settings.fullscreen);
         }
         {
+            engine.worker_callbacks = engine.settings.worker_callbacks;
+            engine.window_state = cge::WindowState{
+                .name = engine.settings.name,
+                .width = engine.settings.width,
+                .height = engine.settings.height,
+                .fullscreen = engine.settings.fullscreen,
+            };
+
+            engine.fixed_timestep = engine.settings.fixed_timestep;
+
+            engine.triple_buffer = engine.settings.triple_buffer;
+            engine.frame_back = 0;
+            engine.mailbox.store(1, std::memory_order::relaxed);
+            engine.frame_front = 2;
+
             engine.render_thread = wyt_spawn(cge::render_main, userdata);
             if (!engine.render_thread) return cge::quit(engine);
 
             engine.update_thread = wyt_spawn(cge::update_main, userdata);
             if (!engine.update_thread) return cge::quit(engine);
+
+            if (engine.worker_callbacks)
+            {
+                engine.game_thread = wyt_spawn(cge::game_main, userdata);
+                if (!engine.game_thread) return cge::quit(engine);
+            }
         }
     }
 
@@ -193,6 +350,11 @@ extern "C"
             wyt_join(engine.render_thread);
         }
 
+        if (engine.game_thread)
+        {
+            wyt_join(engine.game_thread);
+        }
+
         if (engine.window)
         {
             wyn_window_close(engine.window);
@@ -212,6 +374,13 @@ extern "C"
             return;
         }
 
+        if (engine.worker_callbacks)
+        {
+            // The game thread handles the other signals.
+            if (signal & cge::signal_window) cge::apply_window(engine);
+            return;
+        }
+
         const wyn_rect_t old_rect{ wyn_window_position(engine.window) };
         const wyn_bool_t old_fs{ wyn_window_is_fullscreen(engine.window) };
         const char* const old_title{ engine.settings.name };
@@ -219,17 +388,7 @@ extern "C"
         engine.settings.height = old_rect.extent.h;
         engine.settings.fullscreen = old_fs;
 
-        if (signal & cge::signal_render)
-        {
-            engine.game.render(engine, engine.scene);
-            engine.cached_vsync = engine.settings.vsync;
-        }
-
-        if (signal & cge::signal_update)
-        {
-            engine.game.update(engine);
-            engine.cached_fps = engine.settings.fps;
-        }
+        cge::run_callbacks(engine, signal);
 
         {
             const wyn_extent_t new_extent{ .w = engine.settings.width, .h = engine.settings.height };
@@ -259,7 +418,7 @@ extern "C"
         if (window != engine.window) return;
 
         const cge::Event event{ cge::EventFocus { focused } };
-        engine.game.event(engine, event);
+        cge::send_event(engine, event);
     }
 
     void wyn_on_window_reposition(void* const userdata, wyn_window_t const window, wyn_rect_t const content, wyn_coord_t const scale)
@@ -277,8 +436,16 @@ extern "C"
             engine.render_flag.clear(std::memory_order::relaxed);
         }
 
+        if (engine.worker_callbacks)
+        {
+            const std::scoped_lock lock{ engine.window_mutex };
+            engine.window_state.width = content.extent.w;
+            engine.window_state.height = content.extent.h;
+            engine.window_state.fullscreen = wyn_window_is_fullscreen(engine.window);
+        }
+
         const cge::Event event{ cge::EventReposition { content.origin.x, content.origin.y, content.extent.w, content.extent.h, scale } };
-        engine.game.event(engine, event);
+        cge::send_event(engine, event);
     }
 
     void wyn_on_cursor(void*const  userdata, wyn_window_t const window, wyn_coord_t const sx, wyn_coord_t const sy)
@@ -295,21 +462,8 @@ extern "C"
         const wyn_coord_t vy{ sy };
     #endif
 
-        const cge::Viewport view{
-            cge::viewport(
-                cge::uint(content.extent.w), cge::uint(content.extent.h),
-                cge::uint(engine.scene.res_w), cge::uint(engine.scene.res_h),
-                engine.scene.scaling
-            )
-        };
-
-        const wyn_coord_t rel_x{ wyn_coord_t(vx) - wyn_coord_t(view.x) };
-        const wyn_coord_t rel_y{ wyn_coord_t(vy) - wyn_coord_t(view.y) };
-        const wyn_coord_t nrm_x{ (rel_x / wyn_coord_t(view.w)) * 2 - 1 };
-        const wyn_coord_t nrm_y{ (rel_y / wyn_coord_t(view.h)) * 2 - 1 };
-
-        const cge::Event event{ cge::EventCursor { nrm_x, nrm_y } };
-        engine.game.event(engine, event);
+        const cge::Event event{ cge::EventCursor { vx, vy } };
+        cge::send_event(engine, event, content.extent);
     }
 
     void wyn_on_cursor_exit(void* const userdata, wyn_window_t const window)
@@ -318,7 +472,7 @@ extern "C"
         if (window != engine.window) return;
 
         const cge::Event event{ cge::EventCursorExit {} };
-        engine.game.event(engine, event);
+        cge::send_event(engine, event);
     }
     
     void wyn_on_scroll(void* const userdata, wyn_window_t const window, wyn_coord_t const dx, wyn_coord_t const dy)
@@ -327,7 +481,7 @@ extern "C"
         if (window != engine.window) return;
 
         const cge::Event event{ cge::EventScroll { dx, dy } };
-        engine.game.event(engine, event);
+        cge::send_event(engine, event);
     }
     
     void wyn_on_mouse(void* const userdata, wyn_window_t const window, wyn_button_t const button, wyn_bool_t const pressed)
@@ -336,7 +490,7 @@ extern "C"
         if (window != engine.window) return;
 
         const cge::Event event{ cge::EventMouse { button, pressed } };
-        engine.game.event(engine, event);
+        cge::send_event(engine, event);
     }
     
     void wyn_on_keyboard(void* const userdata, wyn_window_t const window, wyn_keycode_t const keycode, wyn_bool_t const pressed)
@@ -345,7 +499,7 @@ extern "C"
         if (window != engine.window) return;
 
         const cge::Event event{ cge::EventKeyboard { keycode, pressed } };
-        engine.game.event(engine, event);
+        cge::send_event(engine, event);
     }
     
     void wyn_on_text(void* const userdata, wyn_window_t const window, const wyn_utf8_t* const text)
@@ -354,40 +508,170 @@ extern "C"
         if (window != engine.window) return;
 
         const cge::Event event{ cge::EventText { text } };
-        engine.game.event(engine, event);
+        cge::send_event(engine, event);
     }
 }
 
 namespace cge
 {
-    static bool await_signal(cge::Engine& engine, const cge::Signal signal) noexcept
+    static bool raise_signal(cge::Engine& engine, const cge::Signal signal) noexcept
     {
-        cge::Signal cached = signal | engine.signal.fetch_or(signal, std::memory_order::relaxed);
+        // Release, so the main thread sees anything the renderer prepared in the Scene.
+        const cge::Signal cached{ engine.signal.fetch_or(signal, std::memory_order::release) };
         if (cached & cge::signal_quit) return false;
 
-        wyn_signal();
+        if (engine.worker_callbacks)
+        {
+            engine.signal.notify_all();
+        }
+        else
+        {
+            wyn_signal();
+        }
+        return true;
+    }
+
+    static bool wait_signal(cge::Engine& engine, const cge::Signal signal) noexcept
+    {
+        cge::Signal cached{ engine.signal.load(std::memory_order::acquire) };
 
         while (cached & signal)
         {
-            engine.signal.wait(cached);
-            cached = engine.signal.load(std::memory_order_acquire);
             if (cached & cge::signal_quit) return false;
+            engine.signal.wait(cached);
+            cached = engine.signal.load(std::memory_order::acquire);
         }
 
-        return true;
+        return !(cached & cge::signal_quit);
+    }
+
+    static bool await_signal(cge::Engine& engine, const cge::Signal signal) noexcept
+    {
+        return cge::raise_signal(engine, signal) && cge::wait_signal(engine, signal);
+    }
+
+    /// Takes the frame last published by the main thread, if it has not been taken yet. Returns the frame to render.
+    static cge::Scene& take_frame(cge::Engine& engine) noexcept
+    {
+        cge::Scene& prev{ engine.frames[engine.frame_front] };
+
+        if (engine.mailbox.load(std::memory_order::relaxed) & cge::mailbox_fresh)
+        {
+            // The counters of `stats` run on across frames, though each frame keeps its own storage.
+            const cge::SceneStats carried{ prev.stats };
+
+            engine.frame_front = engine.mailbox.exchange(engine.frame_front, std::memory_order::acq_rel) & cge::mailbox_slot;
+
+            cge::Scene& next{ engine.frames[engine.frame_front] };
+            next.stats.frames = carried.frames;
+            next.stats.skipped = carried.skipped;
+            next.stats.shrinks = carried.shrinks;
+            return next;
+        }
+
+        return prev;
     }
 
     extern wyt_retval_t WYT_ENTRY render_main(void* const arg) noexcept
     {
         cge::Engine& engine{ *static_cast<cge::Engine*>(arg) };
+
+        // Caps the wait after a skipped frame, so that a slow frame does not delay noticing the next change.
+        constexpr wyt_utime_t max_skip_nanos{ 100'000'000 };
+
+        std::uint64_t rendered_hash{};
+        wyt_utime_t frame_nanos{};
         
+        // Triple-buffered, the game builds the next frame while this thread renders the last one.
+        if (engine.triple_buffer && !cge::raise_signal(engine, cge::signal_render)) return {};
+
         for(;;)
         {
             engine.render_flag.wait(false, std::memory_order::relaxed);
 
-            if (!cge::await_signal(engine, cge::signal_render)) return {};
+            const wyt_utime_t frame_start{ wyt_nanotime() };
+
+            if (engine.triple_buffer)
+            {
+                if (!cge::wait_signal(engine, cge::signal_render)) return {};
+            }
+            else
+            {
+                engine.renderer->prepare(engine);
+                if (!cge::await_signal(engine, cge::signal_render)) return {};
+            }
+
+            cge::Scene& scene{ engine.triple_buffer ? cge::take_frame(engine) : engine.scene };
 
-            engine.renderer->render(engine);
+            if (engine.triple_buffer && !cge::raise_signal(engine, cge::signal_render)) return {};
+
+            if (scene.culling) scene.cull();
+
+            scene.sort_items();
+
+            const std::uint64_t scene_hash{ engine.cached_skip_unchanged ? scene.hash() : 0 };
+            const bool skip{ (scene_hash != 0) && (scene_hash == rendered_hash) && engine.renderer->current(engine) };
+
+            if (skip)
+            {
+                scene.stats.skipped += 1;
+            }
+            else
+            {
+                engine.renderer->render(engine, scene);
+                rendered_hash = scene_hash;
+            }
+
+            // The main thread does not touch the Scene again until the next render signal, or triple-buffered, until it is published again.
+            scene.end_frame();
+
+            if (skip)
+            {
+                // Nothing was presented to pace this thread, so it waits as long as a rendered frame takes instead.
+                wyt_nanosleep_until(frame_start + std::min(frame_nanos, max_skip_nanos));
+            }
+            else
+            {
+                frame_nanos = wyt_nanotime() - frame_start;
+            }
+        }
+    }
+
+    /// Runs an update for every tick of `1 / fps` since the epoch, back to back while behind.
+    static wyt_retval_t fixed_update_main(cge::Engine& engine) noexcept
+    {
+        wyt_utime_t next_tick{ engine.epoch };
+
+        for (;;)
+        {
+            const double fps{ engine.cached_fps };
+            const wyt_utime_t tick_nanos{ (fps > 0) ? static_cast<wyt_utime_t>(1'000'000'000.0 / fps) : 0 };
+
+            if (tick_nanos)
+            {
+                // Returns at once while catching up.
+                wyt_nanosleep_until(next_tick);
+            }
+            else
+            {
+                wyt_yield();
+                next_tick = wyt_nanotime();
+            }
+
+            engine.pending_tick = next_tick;
+            engine.pending_nanos = tick_nanos;
+
+            if (!cge::await_signal(engine, cge::signal_update)) return {};
+
+            next_tick += tick_nanos;
+
+            // Past the allowed backlog, the schedule is pushed back instead of dropping ticks, so the simulation slows down rather than spiralling.
+            const wyt_utime_t max_lag{ tick_nanos * std::max<wyt_utime_t>(engine.cached_max_catch_up, 1) };
+            const wyt_utime_t now{ wyt_nanotime() };
+            if (now > next_tick + max_lag)
+            {
+                next_tick = now - max_lag;
+            }
         }
     }
 
@@ -395,11 +679,16 @@ namespace cge
     {
         cge::Engine& engine{ *static_cast<cge::Engine*>(arg) };
         
+        if (engine.fixed_timestep) return cge::fixed_update_main(engine);
+
         const wyt_utime_t epoch{ engine.epoch };
         wyt_utime_t last_tick{ epoch };
 
         for (;;)
         {
+            engine.pending_tick = wyt_nanotime();
+            engine.pending_nanos = (engine.cached_fps > 0) ? static_cast<wyt_utime_t>(1'000'000'000.0 / engine.cached_fps) : 0;
+
            if (!cge::await_signal(engine, cge::signal_update)) return {};
 
             const double fps{ engine.cached_fps };
@@ -421,4 +710,64 @@ namespace cge
             last_tick = wyt_nanotime();
         }
     }
+
+    extern wyt_retval_t WYT_ENTRY game_main(void* const arg) noexcept
+    {
+        cge::Engine& engine{ *static_cast<cge::Engine*>(arg) };
+
+        constexpr cge::Signal callbacks{ cge::signal_render | cge::signal_update };
+
+        std::vector<cge::QueuedEvent> events{};
+        std::vector<unsigned char> text{};
+
+        for (;;)
+        {
+            cge::Signal cached{ engine.signal.load(std::memory_order::acquire) };
+            while (!(cached & (callbacks | cge::signal_event | cge::signal_quit)))
+            {
+                engine.signal.wait(cached);
+                cached = engine.signal.load(std::memory_order::acquire);
+            }
+            if (cached & cge::signal_quit) return {};
+
+            // Events are delivered first, so that the callbacks see them.
+            cge::deliver_events(engine, events, text);
+
+            const cge::Signal signal{ cge::Signal(cached & callbacks) };
+            if (!signal) continue;
+
+            cge::WindowState old{};
+            {
+                const std::scoped_lock lock{ engine.window_mutex };
+                old = engine.window_state;
+            }
+            engine.settings.width = old.width;
+            engine.settings.height = old.height;
+            engine.settings.fullscreen = old.fullscreen;
+
+            cge::run_callbacks(engine, signal);
+
+            const bool changed{
+                (engine.settings.width != old.width) || (engine.settings.height != old.height) ||
+                (engine.settings.fullscreen != old.fullscreen) || (engine.settings.name != old.name)
+            };
+            if (changed)
+            {
+                {
+                    const std::scoped_lock lock{ engine.window_mutex };
+                    engine.window_request = cge::WindowState{
+                        .name = engine.settings.name,
+                        .width = engine.settings.width,
+                        .height = engine.settings.height,
+                        .fullscreen = engine.settings.fullscreen,
+                    };
+                }
+                (void)engine.signal.fetch_or(cge::signal_window, std::memory_order::relaxed);
+                wyn_signal();
+            }
+
+            (void)engine.signal.fetch_and(cge::Signal(~signal), std::memory_order::release);
+            engine.signal.notify_all();
+        }
+    }
 }
@@ -4,8 +4,12 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <cstring>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 #include <cstdlib>
 #if defined(__WIN32) && !defined(NDEBUG)
@@ -33,6 +37,10 @@ namespace cge
 {
     extern wyt_retval_t WYT_ENTRY update_main(void* arg) noexcept;
     extern wyt_retval_t WYT_ENTRY render_main(void* arg) noexcept;
+    extern wyt_retval_t WYT_ENTRY game_main(void* arg) noexcept;
+
+    /// Fast non-cryptographic hash of `bytes`, continuing from `hash`.
+    extern std::uint64_t hash_bytes(std::uint64_t hash, std::span<const std::byte> bytes) noexcept;
 }
 
 namespace cge
@@ -42,7 +50,11 @@ namespace cge
     public:
         virtual ~Renderer() = default;
         virtual void target_window(cge::Engine& engine, wyn_window_t window);
-        virtual void render(cge::Engine& engine);
+        virtual void prepare(cge::Engine& engine);
+        /// Renders `scene`, which is `cge::Engine::scene` unless the Engine is triple-buffered.
+        virtual void render(cge::Engine& engine, cge::Scene& scene);
+        /// True if the last frame rendered is still on screen, and still fits the window. An unchanged Scene then need not be rendered again.
+        virtual bool current(cge::Engine& engine);
     };
 
     extern cge::Renderer* renderer_vk();
@@ -57,9 +69,37 @@ namespace cge
         signal_quit   = 0b1,
         signal_render = 0b10,
         signal_update = 0b100,
+        signal_event  = 0b1000, ///< Events are queued for the game thread.
+        signal_window = 0b10000, ///< The game thread requested window changes.
+    };
+}
+
+namespace cge
+{
+    /// An event waiting to be passed to the game on the game thread.
+    struct QueuedEvent
+    {
+        cge::Event event;
+        std::size_t text; ///< Offset of an `EventText`'s text in `cge::Engine::event_text`.
+        wyn_extent_t content; ///< Window extent when an `EventCursor` was sent. Its position stays in window units until it is delivered.
+    };
+
+    /// The window properties that `cge::Settings` controls.
+    struct WindowState
+    {
+        const char* name;
+        double width;
+        double height;
+        bool fullscreen;
     };
 }
 
+namespace cge
+{
+    static inline constexpr std::uint8_t mailbox_slot{ 0b11 };
+    static inline constexpr std::uint8_t mailbox_fresh{ 0b100 };
+}
+
 namespace cge
 {
     class Engine final
@@ -75,10 +115,36 @@ namespace cge
         wyn_window_t window;
         wyt_thread_t update_thread;
         wyt_thread_t render_thread;
+        wyt_thread_t game_thread;
 
         std::unique_ptr<cge::Renderer> renderer;
         double cached_fps;
-        bool cached_vsync;
+        std::uint32_t cached_max_catch_up;
+        std::atomic<bool> cached_vsync; ///< Atomic, as the render thread reads it while a triple-buffered frame is being built.
+        bool cached_zero_copy;
+        std::atomic<bool> cached_skip_unchanged; ///< Like `cached_vsync`.
+        bool triple_buffer; ///< `cge::Settings::triple_buffer` when the threads were started.
+        bool worker_callbacks; ///< `cge::Settings::worker_callbacks` when the threads were started.
+        bool fixed_timestep; ///< `cge::Settings::fixed_timestep` when the threads were started.
+
+        wyt_utime_t pending_tick; ///< When the update being signalled was due. Set by the update thread before raising `signal_update`.
+        wyt_utime_t pending_nanos; ///< The update interval at the time.
+        wyt_utime_t last_tick; ///< When the last update was due. Only used by the thread running the game's callbacks.
+        wyt_utime_t tick_nanos; ///< Update interval of the last update. Zero if updates are not paced.
+
+        /// Frames handed from the main thread to the render thread. See `cge::publish_frame`.
+        std::array<cge::Scene, 3> frames;
+        std::atomic<std::uint8_t> mailbox; ///< The frame last published, or `mailbox_fresh` with it if the render thread has not taken it yet.
+        std::uint8_t frame_back; ///< The frame the main thread publishes into next.
+        std::uint8_t frame_front; ///< The frame the render thread is rendering.
+
+        std::mutex event_mutex;
+        std::vector<cge::QueuedEvent> events; ///< Events sent since the game thread last took them.
+        std::vector<unsigned char> event_text; ///< Null-terminated text of the queued `EventText`s.
+
+        std::mutex window_mutex;
+        cge::WindowState window_state; ///< The window as last seen by the main thread.
+        cge::WindowState window_request; ///< The window as last requested by the game thread.
         
         std::atomic<cge::Signal> signal;
         std::atomic_flag render_flag;
@@ -12,6 +12,7 @@ namespace cge
     private:
 
         cvk::Vulkan self;
+        bool presented; ///< A frame has been presented since the swapchain was last made.
 
     public:
 
@@ -19,7 +20,9 @@ namespace cge
         ~Renderer_VK() final;
 
         void target_window(cge::Engine& engine, wyn_window_t window) final;
-        void render(cge::Engine& engine) final;
+        void prepare(cge::Engine& engine) final;
+        void render(cge::Engine& engine, cge::Scene& scene) final;
+        bool current(cge::Engine& engine) final;
 
     };
 }
@@ -47,8 +50,11 @@ namespace cge
             cvk::create_context(self.ctx);
         }
 
+        presented = false;
+
         if (self.gfx.window != nullptr)
         {
+            engine.scene.unborrow();
             cvk::destroy_renderable(self.ctx, self.gfx);
         }
 
@@ -58,25 +64,46 @@ namespace cge
         }
     }
 
-    void Renderer_VK::render(cge::Engine& engine)
+    void Renderer_VK::prepare(cge::Engine& engine)
+    {
+        if (engine.cached_zero_copy)
+        {
+            cvk::lend_scene(self.ctx, self.gfx, engine.scene);
+        }
+        else
+        {
+            engine.scene.unborrow();
+        }
+    }
+
+    void Renderer_VK::render(cge::Engine& engine, cge::Scene& scene)
     {
         constexpr unsigned max_attempts{ 8 };
 
         const VkExtent2D cur_extent{ cvk::full_resolution(self.ctx, self.gfx, true) };
         if (!(cur_extent.width && cur_extent.height)) return;
 
+        presented = false;
+
         if ((cur_extent.width != self.gfx.surface_extent.width) || (cur_extent.height != self.gfx.surface_extent.height) || (engine.cached_vsync != self.gfx.surface_vsync))
         {
+            scene.unborrow();
             cvk::remake_swapchain(self.ctx, self.gfx, engine.cached_vsync);
             if (!(self.gfx.surface_extent.width && self.gfx.surface_extent.height)) return;
         }
 
         for (unsigned attempts{}; attempts < max_attempts; ++attempts)
         {
-            const VkResult res_render{ cvk::render_frame(self.ctx, self.gfx, engine.scene) };
-            if (res_render == VK_SUCCESS) return;
+            const VkResult res_render{ cvk::render_frame(self.ctx, self.gfx, scene) };
+            if (res_render == VK_SUCCESS)
+            {
+                presented = true;
+                return;
+            }
             if (cge::quitting(engine)) return;
 
+            // The swapchain may rebuild the upload buffer that the Scene is building into.
+            scene.unborrow();
             cvk::remake_swapchain(self.ctx, self.gfx, engine.cached_vsync);
             if (!(self.gfx.surface_extent.width && self.gfx.surface_extent.height)) return;
 
@@ -96,4 +123,13 @@ namespace cge
         }
         CGE_LOG("[CGE] RENDER FAILED {} TIMES. ABORTING...\n", max_attempts);
     }
+
+    bool Renderer_VK::current(cge::Engine& engine)
+    {
+        if (!presented) return false;
+
+        // A resized surface or a changed present mode needs a new swapchain, and so a new frame.
+        const VkExtent2D cur_extent{ cvk::full_resolution(self.ctx, self.gfx, true) };
+        return (cur_extent.width == self.gfx.surface_extent.width) && (cur_extent.height == self.gfx.surface_extent.height) && (engine.cached_vsync == self.gfx.surface_vsync);
+    }
 }
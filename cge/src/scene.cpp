@@ -0,0 +1,664 @@
+/**
+ * @file cge/scene.cpp
+ * @brief Bulk drawing into a `cge::Scene`, and its storage retention.
+ */
+
+#include "engine.hpp"
+#include "simd.hpp"
+
+namespace cge
+{
+    template <typename V>
+    static void emit_tris(cge::Buffer<V>& vtx_out, cge::Buffer<cge::Index>& idx_out, std::span<const V> vtx_list);
+
+    template <typename V>
+    static void emit_quads(cge::Buffer<V>& vtx_out, cge::Buffer<cge::Index>& idx_out, std::span<const V> vtx_list);
+
+    template <typename V>
+    static void emit_indexed(cge::Buffer<V>& vtx_out, cge::Buffer<cge::Index>& idx_out, std::span<const V> vtx_list, std::span<const cge::Index> idx_list);
+
+    template <typename T>
+    static bool retain(cge::Buffer<T>& buffer, std::size_t count);
+
+    static cge::SceneCounts max_counts(const cge::SceneCounts& lhs, const cge::SceneCounts& rhs) noexcept;
+
+    static void radix_sort(std::vector<cge::DrawItem>& items, std::vector<cge::DrawItem>& scratch);
+
+    static std::size_t stream_of(cge::DrawKey key) noexcept;
+
+    template <typename V>
+    static bool layout_stream(cge::Scene& scene, std::span<cge::Scene* const> fragments, cge::Buffer<V> cge::Scene::* vtx_of, cge::Buffer<cge::Index> cge::Scene::* idx_of, std::span<std::size_t> vtx_bases, std::span<std::size_t> firsts);
+
+    template <typename V>
+    static void copy_stream(const cge::Buffer<V>& frag_vtx, const cge::Buffer<cge::Index>& frag_idx, V* vtx_out, cge::Index* idx_out, std::size_t vtx_base, std::size_t first) noexcept;
+
+    template <typename T>
+    static cge::uint keep_range(T* data, cge::uint first, cge::uint count, cge::uint dst) noexcept;
+
+    template <typename V>
+    static cge::uint cull_tris(cge::Index* indices, const cge::Buffer<V>& vertices, cge::uint first, cge::uint count, cge::uint dst) noexcept;
+
+    static cge::uint cull_sprites(cge::Sprite* sprites, cge::uint first, cge::uint count, cge::uint dst) noexcept;
+
+    static inline cge::vec2 clip_xy(const cge::Vertex& vtx) noexcept { return cge::vec2{ vtx.xyzw.x, vtx.xyzw.y }; }
+    static inline cge::vec2 clip_xy(const cge::Vertex2D& vtx) noexcept { return vtx.xy; }
+}
+
+namespace cge
+{
+    void Scene::draw_tris(const std::span<const cge::Vertex> vtx_list)
+    { cge::emit_tris(vertices, indices, vtx_list); mark(cge::Pass::triangles, indices.size()); }
+
+    void Scene::draw_tris(const std::span<const cge::Vertex2D> vtx_list)
+    { cge::emit_tris(vertices_2d, indices_2d, vtx_list); mark(cge::Pass::triangles_2d, indices_2d.size()); }
+
+    void Scene::draw_quads(const std::span<const cge::Vertex> vtx_list)
+    { cge::emit_quads(vertices, indices, vtx_list); mark(cge::Pass::triangles, indices.size()); }
+
+    void Scene::draw_quads(const std::span<const cge::Vertex2D> vtx_list)
+    { cge::emit_quads(vertices_2d, indices_2d, vtx_list); mark(cge::Pass::triangles_2d, indices_2d.size()); }
+
+    void Scene::draw_indexed(const std::span<const cge::Vertex> vtx_list, const std::span<const cge::Index> idx_list)
+    { cge::emit_indexed(vertices, indices, vtx_list, idx_list); mark(cge::Pass::triangles, indices.size()); }
+
+    void Scene::draw_indexed(const std::span<const cge::Vertex2D> vtx_list, const std::span<const cge::Index> idx_list)
+    { cge::emit_indexed(vertices_2d, indices_2d, vtx_list, idx_list); mark(cge::Pass::triangles_2d, indices_2d.size()); }
+
+    void Scene::draw_rects(const std::span<const cge::Rect> rect_list)
+    {
+        if (rect_list.empty()) return;
+
+        const cge::Index base{ static_cast<cge::Index>(vertices_2d.size()) };
+
+        cge::Vertex2D* vtx{ vertices_2d.extend(rect_list.size() * 4) };
+        for (const cge::Rect& rect : rect_list)
+        {
+            vtx[0] = cge::Vertex2D{ .xy = { rect.xy0.x, rect.xy0.y }, .u = rect.u0, .v = rect.v0, .rgba = rect.rgba };
+            vtx[1] = cge::Vertex2D{ .xy = { rect.xy1.x, rect.xy0.y }, .u = rect.u1, .v = rect.v0, .rgba = rect.rgba };
+            vtx[2] = cge::Vertex2D{ .xy = { rect.xy1.x, rect.xy1.y }, .u = rect.u1, .v = rect.v1, .rgba = rect.rgba };
+            vtx[3] = cge::Vertex2D{ .xy = { rect.xy0.x, rect.xy1.y }, .u = rect.u0, .v = rect.v1, .rgba = rect.rgba };
+            vtx += 4;
+        }
+
+        simd::quad_u32(indices_2d.extend(rect_list.size() * 6), rect_list.size(), base);
+        mark(cge::Pass::triangles_2d, indices_2d.size());
+    }
+
+    void Scene::mark_all()
+    {
+        mark(cge::Pass::triangles, indices.empty() ? vertices.size() : indices.size());
+        mark(cge::Pass::triangles_2d, indices_2d.empty() ? vertices_2d.size() : indices_2d.size());
+        mark(cge::Pass::sprites, sprites.size());
+    }
+
+    void Scene::merge(const std::span<cge::Scene* const> fragments)
+    {
+        merge_layout(fragments);
+        for (std::size_t idx{}; idx < fragments.size(); ++idx)
+            merge_fragment(fragments, idx);
+    }
+
+    void Scene::merge_layout(const std::span<cge::Scene* const> fragments)
+    {
+        if (fragments.empty()) return;
+
+        mark_all();
+        for (cge::Scene* const fragment : fragments)
+            fragment->mark_all();
+
+        const std::size_t count{ fragments.size() };
+        merge_bases.resize(count * 5);
+        const std::span<std::size_t> bases{ merge_bases };
+        const std::span<std::size_t> firsts_3d{ bases.subspan(count * 1, count) };
+        const std::span<std::size_t> firsts_2d{ bases.subspan(count * 3, count) };
+        const std::span<std::size_t> firsts_sprites{ bases.subspan(count * 4, count) };
+
+        const bool indexed_3d{ cge::layout_stream(*this, fragments, &Scene::vertices, &Scene::indices, bases.subspan(count * 0, count), firsts_3d) };
+        const bool indexed_2d{ cge::layout_stream(*this, fragments, &Scene::vertices_2d, &Scene::indices_2d, bases.subspan(count * 2, count), firsts_2d) };
+
+        std::size_t sprites_end{ sprites.size() };
+        for (std::size_t idx{}; idx < count; ++idx)
+        {
+            firsts_sprites[idx] = sprites_end;
+            sprites_end += fragments[idx]->sprites.size();
+        }
+        sprites.extend(sprites_end - sprites.size());
+
+        // Nothing grows the buffers again until every fragment is copied, so the pointers stay valid.
+        merge_vertices = vertices.data();
+        merge_indices = indexed_3d ? indices.data() : nullptr;
+        merge_vertices_2d = vertices_2d.data();
+        merge_indices_2d = indexed_2d ? indices_2d.data() : nullptr;
+        merge_sprites = sprites.data();
+
+        const std::array<std::span<const std::size_t>, cge::num_passes> firsts{ firsts_3d, firsts_3d, firsts_2d, firsts_sprites };
+        for (std::size_t idx{}; idx < count; ++idx)
+        {
+            const cge::Scene& fragment{ *fragments[idx] };
+            const cge::uint clip_base{ static_cast<cge::uint>(clips.size()) };
+            const cge::uint transform_base{ static_cast<cge::uint>(transforms.size()) };
+
+            for (cge::DrawItem item : fragment.items)
+            {
+                item.first += static_cast<cge::uint>(firsts[cge::stream_of(item.key)][idx]);
+                if (item.clip != 0) item.clip += clip_base;
+                if (item.transform != 0) item.transform += transform_base;
+                items.push_back(item);
+            }
+
+            clips.insert(clips.end(), fragment.clips.begin(), fragment.clips.end());
+            transforms.insert(transforms.end(), fragment.transforms.begin(), fragment.transforms.end());
+            mesh_draws.insert(mesh_draws.end(), fragment.mesh_draws.begin(), fragment.mesh_draws.end());
+        }
+
+        // Everything merged is covered by the fragments' items already.
+        marked[std::size_t(cge::Pass::triangles)] = static_cast<cge::uint>(indexed_3d ? indices.size() : vertices.size());
+        marked[std::size_t(cge::Pass::triangles_2d)] = static_cast<cge::uint>(indexed_2d ? indices_2d.size() : vertices_2d.size());
+        marked[std::size_t(cge::Pass::sprites)] = static_cast<cge::uint>(sprites.size());
+        ++revision;
+    }
+
+    void Scene::merge_fragment(const std::span<cge::Scene* const> fragments, const std::size_t idx) const noexcept
+    {
+        // Only this fragment's ranges are written, through the pointers taken by `merge_layout`, so no state is shared with other copies.
+        const cge::Scene& fragment{ *fragments[idx] };
+        const std::size_t count{ fragments.size() };
+        const std::span<const std::size_t> bases{ merge_bases };
+
+        cge::copy_stream(fragment.vertices, fragment.indices, merge_vertices, merge_indices, bases[count * 0 + idx], bases[count * 1 + idx]);
+        cge::copy_stream(fragment.vertices_2d, fragment.indices_2d, merge_vertices_2d, merge_indices_2d, bases[count * 2 + idx], bases[count * 3 + idx]);
+        std::copy(fragment.sprites.begin(), fragment.sprites.end(), merge_sprites + bases[count * 4 + idx]);
+    }
+
+    void Scene::hand_off(cge::Scene& frame)
+    {
+        frame.res_w = res_w;
+        frame.res_h = res_h;
+        frame.scaling = scaling;
+        frame.backcolor = backcolor;
+        frame.culling = culling;
+        frame.retain_frames = retain_frames;
+
+        if (frame.static_revision != static_revision)
+        {
+            frame.static_vertices = static_vertices;
+            frame.static_indices = static_indices;
+            frame.static_revision = static_revision;
+        }
+
+        if (frame.mesh_revision != mesh_revision)
+        {
+            frame.meshes = meshes;
+            frame.mesh_revision = mesh_revision;
+        }
+
+        // Geometry added straight into the buffers is covered here, as `frame` is never drawn into.
+        mark_all();
+
+        std::swap(vertices, frame.vertices);
+        std::swap(indices, frame.indices);
+        std::swap(vertices_2d, frame.vertices_2d);
+        std::swap(indices_2d, frame.indices_2d);
+        std::swap(sprites, frame.sprites);
+        std::swap(mesh_draws, frame.mesh_draws);
+        std::swap(items, frame.items);
+        std::swap(clips, frame.clips);
+        std::swap(transforms, frame.transforms);
+        std::swap(marked, frame.marked);
+        frame.touch();
+
+        // The frame's stats were last updated when it was rendered, which is the latest the game can see.
+        stats = frame.stats;
+
+        clear();
+    }
+
+    void Scene::sort_items()
+    {
+        mark_all();
+
+        cge::radix_sort(items, item_scratch);
+
+        // Sorting is stable, so a run drawn with one state, clip and transform stays in order and contiguous.
+        std::size_t count{};
+        for (const cge::DrawItem& item : items)
+        {
+            if (count > 0)
+            {
+                cge::DrawItem& prev{ items[count - 1] };
+                const bool same_state{ (cge::draw_state(prev.key) == cge::draw_state(item.key)) && (prev.clip == item.clip) && (prev.transform == item.transform) };
+                if (same_state && (prev.first + prev.count == item.first))
+                {
+                    prev.count += item.count;
+                    continue;
+                }
+            }
+            items[count++] = item;
+        }
+        items.resize(count);
+    }
+
+    void Scene::cull()
+    {
+        mark_all();
+
+        std::array<bool, cge::num_passes> enabled{};
+        enabled[std::size_t(cge::Pass::triangles)] = !indices.empty() && !indices.borrowing() && !vertices.borrowing();
+        enabled[std::size_t(cge::Pass::triangles_2d)] = !indices_2d.empty() && !indices_2d.borrowing() && !vertices_2d.borrowing();
+        enabled[std::size_t(cge::Pass::sprites)] = !sprites.borrowing();
+
+        // Compacting in place only works while each stream's items are in the order of their ranges, as they are when built since the last `clear`.
+        std::array<cge::uint, cge::num_passes> cursor{};
+        for (const cge::DrawItem& item : items)
+        {
+            const std::size_t stream{ cge::stream_of(item.key) };
+            if (item.first < cursor[stream]) enabled[stream] = false;
+            cursor[stream] = item.first + item.count;
+        }
+
+        cursor = {};
+        std::size_t culled{};
+        std::size_t num_items{};
+        for (cge::DrawItem item : items)
+        {
+            const std::size_t stream{ cge::stream_of(item.key) };
+            if (enabled[stream])
+            {
+                cge::uint& dst{ cursor[stream] };
+                cge::uint kept{};
+                // Transformed geometry is only placed by the GPU, so its bounds are not known here. It is moved along, but never culled.
+                const bool test{ item.transform == 0 };
+                switch (static_cast<cge::Pass>(stream))
+                {
+                    case cge::Pass::triangles:
+                        kept = test ? cge::cull_tris(indices.data(), vertices, item.first, item.count, dst) : cge::keep_range(indices.data(), item.first, item.count, dst);
+                        culled += (item.count - kept) / 3;
+                        break;
+                    case cge::Pass::triangles_2d:
+                        kept = test ? cge::cull_tris(indices_2d.data(), vertices_2d, item.first, item.count, dst) : cge::keep_range(indices_2d.data(), item.first, item.count, dst);
+                        culled += (item.count - kept) / 3;
+                        break;
+                    case cge::Pass::sprites:
+                        kept = test ? cge::cull_sprites(sprites.data(), item.first, item.count, dst) : cge::keep_range(sprites.data(), item.first, item.count, dst);
+                        culled += item.count - kept;
+                        break;
+                    case cge::Pass::opaque:
+                        break;
+                }
+                item.first = dst;
+                item.count = kept;
+                dst += kept;
+            }
+            if (item.count > 0) items[num_items++] = item;
+        }
+        items.resize(num_items);
+
+        if (enabled[std::size_t(cge::Pass::triangles)]) indices.truncate(cursor[std::size_t(cge::Pass::triangles)]);
+        if (enabled[std::size_t(cge::Pass::triangles_2d)]) indices_2d.truncate(cursor[std::size_t(cge::Pass::triangles_2d)]);
+
+        // With every triangle culled, the vertices are unreferenced. Dropping them keeps them from being drawn as unindexed geometry.
+        if (enabled[std::size_t(cge::Pass::triangles)] && indices.empty()) vertices.truncate(0);
+        if (enabled[std::size_t(cge::Pass::triangles_2d)] && indices_2d.empty()) vertices_2d.truncate(0);
+        if (enabled[std::size_t(cge::Pass::sprites)]) sprites.truncate(cursor[std::size_t(cge::Pass::sprites)]);
+
+        for (std::size_t stream{}; stream < cge::num_passes; ++stream)
+        {
+            if (enabled[stream]) marked[stream] = cursor[stream];
+        }
+
+        stats.culled = culled;
+        ++revision;
+    }
+
+    std::uint64_t Scene::hash() noexcept
+    {
+        if (vertices.borrowing() || indices.borrowing() || vertices_2d.borrowing() || indices_2d.borrowing() || sprites.borrowing()) return 0;
+
+        // Every flag is taken, so that the next call only sees writes made after this one.
+        const std::array<bool, 5> touched{
+            vertices.take_touched(), indices.take_touched(), vertices_2d.take_touched(), indices_2d.take_touched(), sprites.take_touched(),
+        };
+
+        if ((hashed_body == 0) || (hashed_revision != revision) || (std::ranges::find(touched, true) != touched.end()))
+        {
+            // Reading through a const reference keeps the buffers from counting the reads as writes.
+            const cge::Scene& self{ *this };
+            std::uint64_t body{};
+            body = cge::hash_bytes(body, std::as_bytes(std::span{ self.vertices.data(), self.vertices.size() }));
+            body = cge::hash_bytes(body, std::as_bytes(std::span{ self.indices.data(), self.indices.size() }));
+            body = cge::hash_bytes(body, std::as_bytes(std::span{ self.vertices_2d.data(), self.vertices_2d.size() }));
+            body = cge::hash_bytes(body, std::as_bytes(std::span{ self.indices_2d.data(), self.indices_2d.size() }));
+            body = cge::hash_bytes(body, std::as_bytes(std::span{ self.sprites.data(), self.sprites.size() }));
+            body = cge::hash_bytes(body, std::as_bytes(std::span{ mesh_draws }));
+            body = cge::hash_bytes(body, std::as_bytes(std::span{ items }));
+            body = cge::hash_bytes(body, std::as_bytes(std::span{ clips }));
+            body = cge::hash_bytes(body, std::as_bytes(std::span{ transforms }));
+            hashed_body = body;
+            hashed_revision = revision;
+        }
+
+        const std::array<std::uint64_t, 7> header{
+            res_w, res_h, std::uint64_t(scaling), backcolor, static_revision, mesh_revision, hashed_body,
+        };
+        const std::uint64_t result{ cge::hash_bytes(0, std::as_bytes(std::span{ header })) };
+
+        // Zero is reserved for "unknown".
+        return result ? result : 1;
+    }
+
+    void Scene::end_frame()
+    {
+        const cge::SceneCounts used{
+            .vertices = vertices.size(),
+            .indices = indices.size(),
+            .vertices_2d = vertices_2d.size(),
+            .indices_2d = indices_2d.size(),
+            .sprites = sprites.size(),
+        };
+
+        stats.frames += 1;
+        stats.used = used;
+        stats.used_bytes = used.vertices * sizeof(cge::Vertex) + used.indices * sizeof(cge::Index)
+                         + used.vertices_2d * sizeof(cge::Vertex2D) + used.indices_2d * sizeof(cge::Index)
+                         + used.sprites * sizeof(cge::Sprite);
+        stats.growths = vertices.take_growths() + indices.take_growths() + vertices_2d.take_growths() + indices_2d.take_growths() + sprites.take_growths();
+
+        window_peak = cge::max_counts(window_peak, used);
+        stats.peak = cge::max_counts(prev_peak, window_peak);
+
+        if (retain_frames && (++window_frames >= retain_frames))
+        {
+            // Together, the previous and current windows cover at least the last `retain_frames` frames.
+            std::uint32_t shrinks{};
+            shrinks += cge::retain(vertices, stats.peak.vertices);
+            shrinks += cge::retain(indices, stats.peak.indices);
+            shrinks += cge::retain(vertices_2d, stats.peak.vertices_2d);
+            shrinks += cge::retain(indices_2d, stats.peak.indices_2d);
+            shrinks += cge::retain(sprites, stats.peak.sprites);
+            stats.shrinks += shrinks;
+
+            prev_peak = window_peak;
+            window_peak = {};
+            window_frames = 0;
+        }
+
+        stats.owned_bytes = vertices.owned_bytes() + indices.owned_bytes() + vertices_2d.owned_bytes() + indices_2d.owned_bytes() + sprites.owned_bytes();
+    }
+}
+
+namespace cge
+{
+    template <typename V>
+    void emit_tris(cge::Buffer<V>& vtx_out, cge::Buffer<cge::Index>& idx_out, const std::span<const V> vtx_list)
+    {
+        const std::size_t count{ vtx_list.size() - vtx_list.size() % 3 };
+        if (count == 0) return;
+
+        const cge::Index base{ static_cast<cge::Index>(vtx_out.size()) };
+
+        vtx_out.append(vtx_list.first(count));
+        simd::iota_u32(idx_out.extend(count), count, base);
+    }
+
+    template <typename V>
+    void emit_quads(cge::Buffer<V>& vtx_out, cge::Buffer<cge::Index>& idx_out, const std::span<const V> vtx_list)
+    {
+        const std::size_t quads{ vtx_list.size() / 4 };
+        if (quads == 0) return;
+
+        const cge::Index base{ static_cast<cge::Index>(vtx_out.size()) };
+
+        vtx_out.append(vtx_list.first(quads * 4));
+        simd::quad_u32(idx_out.extend(quads * 6), quads, base);
+    }
+
+    template <typename V>
+    void emit_indexed(cge::Buffer<V>& vtx_out, cge::Buffer<cge::Index>& idx_out, const std::span<const V> vtx_list, const std::span<const cge::Index> idx_list)
+    {
+        const std::size_t count{ idx_list.size() - idx_list.size() % 3 };
+        if (vtx_list.empty() || (count == 0)) return;
+
+        const cge::Index base{ static_cast<cge::Index>(vtx_out.size()) };
+
+        vtx_out.append(vtx_list);
+        simd::rebase_u32(idx_out.extend(count), idx_list.data(), count, base);
+    }
+
+    template <typename T>
+    bool retain(cge::Buffer<T>& buffer, const std::size_t count)
+    {
+        // Keep some headroom over the peak, and only shrink when well over it, so that usage hovering around the peak does not reallocate.
+        const std::size_t target{ count + count / 8 };
+        if (buffer.owned_bytes() / sizeof(T) <= target + target / 2) return false;
+
+        return buffer.shrink(target);
+    }
+
+    cge::SceneCounts max_counts(const cge::SceneCounts& lhs, const cge::SceneCounts& rhs) noexcept
+    {
+        return cge::SceneCounts{
+            .vertices = std::max(lhs.vertices, rhs.vertices),
+            .indices = std::max(lhs.indices, rhs.indices),
+            .vertices_2d = std::max(lhs.vertices_2d, rhs.vertices_2d),
+            .indices_2d = std::max(lhs.indices_2d, rhs.indices_2d),
+            .sprites = std::max(lhs.sprites, rhs.sprites),
+        };
+    }
+    void radix_sort(std::vector<cge::DrawItem>& items, std::vector<cge::DrawItem>& scratch)
+    {
+        if (items.size() < 2) return;
+
+        // One histogram per byte of the key, all built in a single pass.
+        std::array<std::array<std::uint32_t, 256>, 8> histograms{};
+        for (const cge::DrawItem& item : items)
+        {
+            for (std::size_t byte{}; byte < 8; ++byte)
+                ++histograms[byte][(item.key >> (byte * 8)) & 0xFF];
+        }
+
+        scratch.resize(items.size());
+        cge::DrawItem* src{ items.data() };
+        cge::DrawItem* dst{ scratch.data() };
+
+        // Least significant byte first. Each pass is stable, so it keeps the order of the passes before it.
+        for (std::size_t byte{}; byte < 8; ++byte)
+        {
+            const std::size_t shift{ byte * 8 };
+            std::array<std::uint32_t, 256>& offsets{ histograms[byte] };
+
+            // Most frames only use a few layers and depths, so most bytes are the same for every item.
+            if (offsets[(src[0].key >> shift) & 0xFF] == items.size()) continue;
+
+            std::uint32_t sum{};
+            for (std::uint32_t& offset : offsets)
+                sum += std::exchange(offset, sum);
+
+            for (std::size_t idx{}; idx < items.size(); ++idx)
+                dst[offsets[(src[idx].key >> shift) & 0xFF]++] = src[idx];
+
+            std::swap(src, dst);
+        }
+
+        if (src != items.data())
+            std::copy(src, src + items.size(), items.data());
+    }
+}
+
+namespace cge
+{
+    std::uint64_t hash_bytes(const std::uint64_t hash, const std::span<const std::byte> bytes) noexcept
+    {
+        constexpr std::uint64_t prime{ 0x9E37'79B9'7F4A'7C15 };
+        const std::byte* const src{ bytes.data() };
+        const std::size_t size{ bytes.size() };
+
+        // Four independent lanes, so that the multiplies of consecutive words overlap.
+        std::array<std::uint64_t, 4> lanes{ hash, hash + prime, hash - prime, ~hash };
+        std::size_t idx{};
+        for (; idx + 32 <= size; idx += 32)
+        {
+            for (std::size_t lane{}; lane < 4; ++lane)
+            {
+                std::uint64_t word{};
+                std::memcpy(&word, src + idx + lane * 8, 8);
+                lanes[lane] = std::rotl(lanes[lane] ^ word, 31) * prime;
+            }
+        }
+        for (std::size_t lane{}; idx < size; idx += 8, ++lane)
+        {
+            std::uint64_t word{};
+            std::memcpy(&word, src + idx, std::min<std::size_t>(8, size - idx));
+            lanes[lane] = std::rotl(lanes[lane] ^ word, 31) * prime;
+        }
+
+        std::uint64_t result{ size };
+        for (const std::uint64_t lane : lanes)
+            result = std::rotl(result ^ lane, 27) * prime;
+
+        return result ^ (result >> 32);
+    }
+
+    template <typename V>
+    bool layout_stream(cge::Scene& scene, const std::span<cge::Scene* const> fragments, cge::Buffer<V> cge::Scene::* const vtx_of, cge::Buffer<cge::Index> cge::Scene::* const idx_of, const std::span<std::size_t> vtx_bases, const std::span<std::size_t> firsts)
+    {
+        cge::Buffer<V>& vtx{ scene.*vtx_of };
+        cge::Buffer<cge::Index>& idx{ scene.*idx_of };
+
+        // Items refer to indices if a stream has any, and to vertices otherwise, so the merged stream is indexed if any part of it is.
+        bool indexed{ !idx.empty() };
+        for (const cge::Scene* const fragment : fragments)
+            indexed |= !(fragment->*idx_of).empty();
+
+        // Unindexed geometry is given the indices 0, 1, 2, ..., which leaves the ranges of its items as they are.
+        if (indexed && idx.empty() && !vtx.empty())
+            simd::iota_u32(idx.extend(vtx.size()), vtx.size(), 0);
+
+        // An exclusive prefix sum of the fragments' sizes places each fragment after this Scene's own geometry.
+        std::size_t vtx_end{ vtx.size() };
+        std::size_t first_end{ indexed ? idx.size() : vtx.size() };
+        for (std::size_t frag{}; frag < fragments.size(); ++frag)
+        {
+            const cge::Scene& fragment{ *fragments[frag] };
+            const std::size_t frag_vtx{ (fragment.*vtx_of).size() };
+            const std::size_t frag_idx{ (fragment.*idx_of).size() };
+
+            vtx_bases[frag] = vtx_end;
+            firsts[frag] = first_end;
+            vtx_end += frag_vtx;
+            first_end += (indexed && (frag_idx > 0)) ? frag_idx : frag_vtx;
+        }
+
+        vtx.extend(vtx_end - vtx.size());
+        if (indexed) idx.extend(first_end - idx.size());
+
+        return indexed;
+    }
+
+    template <typename V>
+    void copy_stream(const cge::Buffer<V>& frag_vtx, const cge::Buffer<cge::Index>& frag_idx, V* const vtx_out, cge::Index* const idx_out, const std::size_t vtx_base, const std::size_t first) noexcept
+    {
+        std::copy(frag_vtx.begin(), frag_vtx.end(), vtx_out + vtx_base);
+
+        if (idx_out == nullptr) return;
+
+        const cge::Index base{ static_cast<cge::Index>(vtx_base) };
+        if (frag_idx.empty())
+            simd::iota_u32(idx_out + first, frag_vtx.size(), base);
+        else
+            simd::rebase_u32(idx_out + first, frag_idx.data(), frag_idx.size(), base);
+    }
+
+    std::size_t stream_of(const cge::DrawKey key) noexcept
+    {
+        // Opaque triangles are drawn from the same stream as the other 3D triangles.
+        const cge::Pass pass{ cge::draw_pass(key) };
+        return std::size_t((pass == cge::Pass::opaque) ? cge::Pass::triangles : pass);
+    }
+
+    /// Moves `count` elements from `first` down to `dst`, untested.
+    template <typename T>
+    cge::uint keep_range(T* const data, const cge::uint first, const cge::uint count, const cge::uint dst) noexcept
+    {
+        if (dst != first) std::copy(data + first, data + first + count, data + dst);
+        return count;
+    }
+
+    template <typename V>
+    cge::uint cull_tris(cge::Index* const indices, const cge::Buffer<V>& vertices, const cge::uint first, const cge::uint count, const cge::uint dst) noexcept
+    {
+        const cge::Index* const src{ indices + first };
+        cge::Index* const out{ indices + dst };
+        const std::size_t tris{ count / 3 };
+
+        // `out` never runs ahead of `src`, and each group of 4 triangles is read out before any of it is written.
+        cge::uint kept{};
+        for (std::size_t tri{}; tri < tris; tri += 4)
+        {
+            const std::size_t lanes{ std::min<std::size_t>(4, tris - tri) };
+
+            cge::Index group[12]{};
+            float min_x[4]{}, max_x[4]{}, min_y[4]{}, max_y[4]{};
+            for (std::size_t lane{}; lane < lanes; ++lane)
+            {
+                std::copy(src + (tri + lane) * 3, src + (tri + lane) * 3 + 3, group + lane * 3);
+
+                // Triangles with an invalid index are kept, and left for the GPU to deal with.
+                if ((group[lane * 3] >= vertices.size()) || (group[lane * 3 + 1] >= vertices.size()) || (group[lane * 3 + 2] >= vertices.size())) continue;
+
+                const cge::vec2 xy0{ cge::clip_xy(vertices[group[lane * 3    ]]) };
+                const cge::vec2 xy1{ cge::clip_xy(vertices[group[lane * 3 + 1]]) };
+                const cge::vec2 xy2{ cge::clip_xy(vertices[group[lane * 3 + 2]]) };
+                min_x[lane] = std::min({ xy0.x, xy1.x, xy2.x });
+                max_x[lane] = std::max({ xy0.x, xy1.x, xy2.x });
+                min_y[lane] = std::min({ xy0.y, xy1.y, xy2.y });
+                max_y[lane] = std::max({ xy0.y, xy1.y, xy2.y });
+            }
+
+            const unsigned outside{ simd::offscreen_x4(min_x, max_x, min_y, max_y) };
+            for (std::size_t lane{}; lane < lanes; ++lane)
+            {
+                if (outside & (1u << lane)) continue;
+                std::copy(group + lane * 3, group + lane * 3 + 3, out + kept);
+                kept += 3;
+            }
+        }
+
+        return kept;
+    }
+
+    cge::uint cull_sprites(cge::Sprite* const sprites, const cge::uint first, const cge::uint count, const cge::uint dst) noexcept
+    {
+        const cge::Sprite* const src{ sprites + first };
+        cge::Sprite* const out{ sprites + dst };
+
+        cge::uint kept{};
+        for (cge::uint idx{}; idx < count; idx += 4)
+        {
+            const cge::uint lanes{ std::min<cge::uint>(4, count - idx) };
+
+            cge::Sprite group[4]{};
+            float min_x[4]{}, max_x[4]{}, min_y[4]{}, max_y[4]{};
+            for (cge::uint lane{}; lane < lanes; ++lane)
+            {
+                group[lane] = src[idx + lane];
+
+                // Bounded by the circle through the corners, which holds at any rotation.
+                const cge::vec2 scale{ group[lane].scale };
+                const float radius{ 0.5f * std::sqrt(scale.x * scale.x + scale.y * scale.y) };
+                min_x[lane] = group[lane].xy.x - radius;
+                max_x[lane] = group[lane].xy.x + radius;
+                min_y[lane] = group[lane].xy.y - radius;
+                max_y[lane] = group[lane].xy.y + radius;
+            }
+
+            const unsigned outside{ simd::offscreen_x4(min_x, max_x, min_y, max_y) };
+            for (cge::uint lane{}; lane < lanes; ++lane)
+            {
+                if (outside & (1u << lane)) continue;
+                out[kept++] = group[lane];
+            }
+        }
+
+        return kept;
+    }
+}
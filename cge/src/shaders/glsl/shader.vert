@@ -11,6 +11,13 @@ layout(location = 1) in vec2 in_UV;
 // Input ST values.
 layout(location = 2) in uvec2 in_ST;
 
+// Per-draw values, pushed whenever they change.
+layout(push_constant) uniform DrawConstants
+{
+    mat4 transform;
+    vec4 tint;
+} draw;
+
 // Output RGBA values.
 layout(location = 0) out vec4 out_RGBA;
 
@@ -38,7 +45,7 @@ float to_srgb(const float val)
 void main()
 {
     // Use only the XYZ-coordinates.
-    gl_Position = vec4(in_XYZW.xyz, 1.0);
+    gl_Position = draw.transform * vec4(in_XYZW.xyz, 1.0);
     
     uint s = in_ST.x;
     uint t = in_ST.y;
@@ -53,8 +60,8 @@ void main()
     g = from_srgb(g);
     b = from_srgb(b);
 
-    // Pass-through the RGBA Values. They will be interpolated between each point.
-    out_RGBA = vec4(r, g, b, a);
+    // Pass-through the tinted RGBA Values. They will be interpolated between each point.
+    out_RGBA = vec4(r, g, b, a) * draw.tint;
 
     // Pass-through the UV Values. They will be interpolated between each point.
     out_UV = in_UV;
@@ -0,0 +1,67 @@
+#version 450
+
+// ================================================================
+
+// True if the RGBA input is fetched as UNORM, and must be decoded from sRGB here.
+layout(constant_id = 0) const bool decode_srgb = false;
+
+// Input XY values.
+layout(location = 0) in vec2 in_XY;
+
+// Input UV values (UNORM16).
+layout(location = 1) in vec2 in_UV;
+
+// Input RGBA values (B8G8R8A8, decoded by the vertex fetch).
+layout(location = 2) in vec4 in_RGBA;
+
+// Per-draw values, pushed whenever they change.
+layout(push_constant) uniform DrawConstants
+{
+    mat4 transform;
+    vec4 tint;
+} draw;
+
+// Output RGBA values.
+layout(location = 0) out vec4 out_RGBA;
+
+// Output UV values.
+layout(location = 1) out vec2 out_UV;
+
+// Output T value.
+layout(location = 2) out uint out_T;
+
+// ================================================================
+
+float from_srgb(const float val)
+{
+    return val < 0.04045 ? val / 12.92 : pow((val + 0.055) / 1.055, 2.4);
+}
+
+// ================================================================
+
+// Vertex Shader entry-point.
+void main()
+{
+    gl_Position = draw.transform * vec4(in_XY, 0.0, 1.0);
+
+    vec4 rgba = in_RGBA;
+
+    // Gamma Correction, only if the hardware could not do it.
+    if (decode_srgb)
+    {
+        rgba.r = from_srgb(rgba.r);
+        rgba.g = from_srgb(rgba.g);
+        rgba.b = from_srgb(rgba.b);
+    }
+
+    // Pass-through the tinted RGBA Values. They will be interpolated between each point.
+    out_RGBA = rgba * draw.tint;
+
+    // Pass-through the UV Values. They will be interpolated between each point.
+    out_UV = in_UV;
+
+    // Compact vertices are always textured.
+    out_T = 1;
+}
+
+// ================================================================
@@ -0,0 +1,81 @@
+#version 450
+
+// ================================================================
+
+// True if the RGBA input is fetched as UNORM, and must be decoded from sRGB here.
+layout(constant_id = 0) const bool decode_srgb = false;
+
+// Input XY values (centre), per instance.
+layout(location = 0) in vec2 in_XY;
+
+// Input width and height, per instance.
+layout(location = 1) in vec2 in_Scale;
+
+// Input rotation in radians, per instance.
+layout(location = 2) in float in_Rotation;
+
+// Input UV rectangle (UNORM16, U0 V0 U1 V1), per instance.
+layout(location = 3) in vec4 in_UVRect;
+
+// Input RGBA values (B8G8R8A8, decoded by the vertex fetch), per instance.
+layout(location = 4) in vec4 in_RGBA;
+
+// Per-draw values, pushed whenever they change.
+layout(push_constant) uniform DrawConstants
+{
+    mat4 transform;
+    vec4 tint;
+} draw;
+
+// Output RGBA values.
+layout(location = 0) out vec4 out_RGBA;
+
+// Output UV values.
+layout(location = 1) out vec2 out_UV;
+
+// Output T value.
+layout(location = 2) out uint out_T;
+
+// ================================================================
+
+float from_srgb(const float val)
+{
+    return val < 0.04045 ? val / 12.92 : pow((val + 0.055) / 1.055, 2.4);
+}
+
+// ================================================================
+
+// Vertex Shader entry-point.
+void main()
+{
+    // The quad is drawn as a 4-vertex strip: (0,0), (1,0), (0,1), (1,1).
+    vec2 corner = vec2(float(gl_VertexIndex & 1), float((gl_VertexIndex >> 1) & 1));
+
+    vec2 local = (corner - 0.5) * in_Scale;
+    float c = cos(in_Rotation);
+    float s = sin(in_Rotation);
+    vec2 rotated = vec2(local.x * c - local.y * s, local.x * s + local.y * c);
+
+    gl_Position = draw.transform * vec4(in_XY + rotated, 0.0, 1.0);
+
+    vec4 rgba = in_RGBA;
+
+    // Gamma Correction, only if the hardware could not do it.
+    if (decode_srgb)
+    {
+        rgba.r = from_srgb(rgba.r);
+        rgba.g = from_srgb(rgba.g);
+        rgba.b = from_srgb(rgba.b);
+    }
+
+    // Pass-through the tinted RGBA Values.
+    out_RGBA = rgba * draw.tint;
+
+    // Pick this corner's UV Values from the rectangle.
+    out_UV = mix(in_UVRect.xy, in_UVRect.zw, corner);
+
+    // Sprites are always textured.
+    out_T = 1;
+}
+
+// ================================================================
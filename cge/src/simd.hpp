@@ -0,0 +1,258 @@
+/**
+ * @file cge/simd.hpp
+ * @brief Vectorized kernels for bulk data conversion, index generation and culling.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+    #define CGE_SIMD_SSE2
+#endif
+#if defined(__AVX2__)
+    #include <immintrin.h>
+    #define CGE_SIMD_AVX2
+#endif
+#if defined(__ARM_NEON)
+    #include <arm_neon.h>
+    #define CGE_SIMD_NEON
+#endif
+
+namespace simd
+{
+    /**
+     * @brief Narrows `count` 32-bit indices to 16 bits.
+     * @details Every element of `src` must be at most `0xFFFF`. `dst` may point into write-combined (mapped GPU) memory, so it is only ever written sequentially.
+     */
+    static inline void narrow_u16(std::uint16_t* const dst, const std::uint32_t* const src, const std::size_t count) noexcept
+    {
+        std::size_t idx{};
+
+    #if defined(CGE_SIMD_AVX2)
+        for (; idx + 16 <= count; idx += 16)
+        {
+            const __m256i lo{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + idx)) };
+            const __m256i hi{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + idx + 8)) };
+            // `packus` works per 128-bit lane, so the quadwords come out as [lo0 hi0 lo1 hi1].
+            const __m256i packed{ _mm256_packus_epi32(lo, hi) };
+            const __m256i ordered{ _mm256_permute4x64_epi64(packed, 0b11'01'10'00) };
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + idx), ordered);
+        }
+    #endif
+
+    #if defined(CGE_SIMD_SSE2)
+        // SSE2 only has a signed saturating pack, so bias the values into the signed range and back.
+        const __m128i bias32{ _mm_set1_epi32(0x8000) };
+        const __m128i bias16{ _mm_set1_epi16(std::int16_t(-0x8000)) };
+        for (; idx + 8 <= count; idx += 8)
+        {
+            const __m128i lo{ _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + idx)), bias32) };
+            const __m128i hi{ _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + idx + 4)), bias32) };
+            const __m128i packed{ _mm_xor_si128(_mm_packs_epi32(lo, hi), bias16) };
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + idx), packed);
+        }
+    #endif
+
+    #if defined(CGE_SIMD_NEON)
+        for (; idx + 8 <= count; idx += 8)
+        {
+            const uint16x4_t lo{ vmovn_u32(vld1q_u32(src + idx)) };
+            const uint16x4_t hi{ vmovn_u32(vld1q_u32(src + idx + 4)) };
+            vst1q_u16(dst + idx, vcombine_u16(lo, hi));
+        }
+    #endif
+
+        for (; idx < count; ++idx)
+        {
+            dst[idx] = static_cast<std::uint16_t>(src[idx]);
+        }
+    }
+
+    /// Writes `base, base + 1, ..., base + count - 1` to `dst`.
+    static inline void iota_u32(std::uint32_t* const dst, const std::size_t count, const std::uint32_t base) noexcept
+    {
+        std::size_t idx{};
+
+    #if defined(CGE_SIMD_AVX2)
+        {
+            const __m256i step{ _mm256_set1_epi32(8) };
+            __m256i vals{ _mm256_add_epi32(_mm256_set1_epi32(std::int32_t(base)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)) };
+            for (; idx + 8 <= count; idx += 8)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + idx), vals);
+                vals = _mm256_add_epi32(vals, step);
+            }
+        }
+    #endif
+
+    #if defined(CGE_SIMD_SSE2)
+        {
+            const __m128i step{ _mm_set1_epi32(4) };
+            __m128i vals{ _mm_add_epi32(_mm_set1_epi32(std::int32_t(base + std::uint32_t(idx))), _mm_setr_epi32(0, 1, 2, 3)) };
+            for (; idx + 4 <= count; idx += 4)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + idx), vals);
+                vals = _mm_add_epi32(vals, step);
+            }
+        }
+    #endif
+
+    #if defined(CGE_SIMD_NEON)
+        {
+            const std::uint32_t lanes[4]{ 0, 1, 2, 3 };
+            const uint32x4_t step{ vdupq_n_u32(4) };
+            uint32x4_t vals{ vaddq_u32(vdupq_n_u32(base + std::uint32_t(idx)), vld1q_u32(lanes)) };
+            for (; idx + 4 <= count; idx += 4)
+            {
+                vst1q_u32(dst + idx, vals);
+                vals = vaddq_u32(vals, step);
+            }
+        }
+    #endif
+
+        for (; idx < count; ++idx)
+        {
+            dst[idx] = base + static_cast<std::uint32_t>(idx);
+        }
+    }
+
+    /// Writes `src[i] + base` to `dst[i]`.
+    static inline void rebase_u32(std::uint32_t* const dst, const std::uint32_t* const src, const std::size_t count, const std::uint32_t base) noexcept
+    {
+        std::size_t idx{};
+
+    #if defined(CGE_SIMD_AVX2)
+        {
+            const __m256i offs{ _mm256_set1_epi32(std::int32_t(base)) };
+            for (; idx + 8 <= count; idx += 8)
+            {
+                const __m256i vals{ _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + idx)) };
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + idx), _mm256_add_epi32(vals, offs));
+            }
+        }
+    #endif
+
+    #if defined(CGE_SIMD_SSE2)
+        {
+            const __m128i offs{ _mm_set1_epi32(std::int32_t(base)) };
+            for (; idx + 4 <= count; idx += 4)
+            {
+                const __m128i vals{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + idx)) };
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + idx), _mm_add_epi32(vals, offs));
+            }
+        }
+    #endif
+
+    #if defined(CGE_SIMD_NEON)
+        {
+            const uint32x4_t offs{ vdupq_n_u32(base) };
+            for (; idx + 4 <= count; idx += 4)
+            {
+                vst1q_u32(dst + idx, vaddq_u32(vld1q_u32(src + idx), offs));
+            }
+        }
+    #endif
+
+        for (; idx < count; ++idx)
+        {
+            dst[idx] = src[idx] + base;
+        }
+    }
+
+    /**
+     * @brief Writes the indices of `quads` quads, 6 per quad, for the vertices starting at `base`.
+     * @details Each quad `(v0, v1, v2, v3)` is split like a fan: `(v1, v2, v0)` and `(v2, v3, v0)`.
+     */
+    static inline void quad_u32(std::uint32_t* const dst, const std::size_t quads, const std::uint32_t base) noexcept
+    {
+        std::size_t quad{};
+
+    #if defined(CGE_SIMD_SSE2) || defined(CGE_SIMD_NEON)
+        // Two quads are 12 indices, which is exactly three vectors of 4.
+        alignas(16) static constexpr std::uint32_t pattern[12]{ 1, 2, 0, 2, 3, 0, 5, 6, 4, 6, 7, 4 };
+    #endif
+
+    #if defined(CGE_SIMD_SSE2)
+        {
+            const __m128i step{ _mm_set1_epi32(8) };
+            __m128i offs{ _mm_set1_epi32(std::int32_t(base)) };
+            const __m128i pat0{ _mm_load_si128(reinterpret_cast<const __m128i*>(pattern + 0)) };
+            const __m128i pat1{ _mm_load_si128(reinterpret_cast<const __m128i*>(pattern + 4)) };
+            const __m128i pat2{ _mm_load_si128(reinterpret_cast<const __m128i*>(pattern + 8)) };
+            for (; quad + 2 <= quads; quad += 2)
+            {
+                std::uint32_t* const out{ dst + quad * 6 };
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 0), _mm_add_epi32(pat0, offs));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4), _mm_add_epi32(pat1, offs));
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_add_epi32(pat2, offs));
+                offs = _mm_add_epi32(offs, step);
+            }
+        }
+    #endif
+
+    #if defined(CGE_SIMD_NEON)
+        {
+            const uint32x4_t step{ vdupq_n_u32(8) };
+            uint32x4_t offs{ vdupq_n_u32(base) };
+            const uint32x4_t pat0{ vld1q_u32(pattern + 0) };
+            const uint32x4_t pat1{ vld1q_u32(pattern + 4) };
+            const uint32x4_t pat2{ vld1q_u32(pattern + 8) };
+            for (; quad + 2 <= quads; quad += 2)
+            {
+                std::uint32_t* const out{ dst + quad * 6 };
+                vst1q_u32(out + 0, vaddq_u32(pat0, offs));
+                vst1q_u32(out + 4, vaddq_u32(pat1, offs));
+                vst1q_u32(out + 8, vaddq_u32(pat2, offs));
+                offs = vaddq_u32(offs, step);
+            }
+        }
+    #endif
+
+        for (; quad < quads; ++quad)
+        {
+            const std::uint32_t v0{ base + static_cast<std::uint32_t>(quad * 4) };
+            std::uint32_t* const out{ dst + quad * 6 };
+            out[0] = v0 + 1;
+            out[1] = v0 + 2;
+            out[2] = v0;
+            out[3] = v0 + 2;
+            out[4] = v0 + 3;
+            out[5] = v0;
+        }
+    }
+
+    /**
+     * @brief Tests 4 bounding boxes against clip space.
+     * @details Bit `i` of the result is set if box `i` lies entirely outside `[-1, 1]` on X or on Y. NaN bounds are never outside.
+     */
+    static inline unsigned offscreen_x4(const float* const min_x, const float* const max_x, const float* const min_y, const float* const max_y) noexcept
+    {
+    #if defined(CGE_SIMD_SSE2)
+        const __m128 lo{ _mm_set1_ps(-1.0f) };
+        const __m128 hi{ _mm_set1_ps(1.0f) };
+        const __m128 out_x{ _mm_or_ps(_mm_cmplt_ps(_mm_loadu_ps(max_x), lo), _mm_cmpgt_ps(_mm_loadu_ps(min_x), hi)) };
+        const __m128 out_y{ _mm_or_ps(_mm_cmplt_ps(_mm_loadu_ps(max_y), lo), _mm_cmpgt_ps(_mm_loadu_ps(min_y), hi)) };
+        return static_cast<unsigned>(_mm_movemask_ps(_mm_or_ps(out_x, out_y)));
+    #elif defined(CGE_SIMD_NEON)
+        const float32x4_t lo{ vdupq_n_f32(-1.0f) };
+        const float32x4_t hi{ vdupq_n_f32(1.0f) };
+        const uint32x4_t out_x{ vorrq_u32(vcltq_f32(vld1q_f32(max_x), lo), vcgtq_f32(vld1q_f32(min_x), hi)) };
+        const uint32x4_t out_y{ vorrq_u32(vcltq_f32(vld1q_f32(max_y), lo), vcgtq_f32(vld1q_f32(min_y), hi)) };
+        std::uint32_t lanes[4];
+        vst1q_u32(lanes, vorrq_u32(out_x, out_y));
+        return static_cast<unsigned>((lanes[0] & 1) | (lanes[1] & 2) | (lanes[2] & 4) | (lanes[3] & 8));
+    #else
+        unsigned mask{};
+        for (unsigned lane{}; lane < 4; ++lane)
+        {
+            const bool outside{ (max_x[lane] < -1.0f) || (min_x[lane] > 1.0f) || (max_y[lane] < -1.0f) || (min_y[lane] > 1.0f) };
+            mask |= unsigned(outside) << lane;
+        }
+        return mask;
+    #endif
+    }
+}
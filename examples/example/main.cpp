@@ -179,6 +179,8 @@ void App::render([[maybe_unused]] cge::Engine& engine, cge::Scene& scene)
         255 - std::abs(255 - int((this->updates * 2) % 510)),
         255
     );
+    scene.opaque = true;
+    scene.depth = 1.0f;
     scene.draw_strip(
         std::array
         {
@@ -188,6 +190,8 @@ void App::render([[maybe_unused]] cge::Engine& engine, cge::Scene& scene)
             cge::Vertex{ .xyzw = { -1.0f,  1.0f, 1.0f }, .st = { backcolor } },
         }
     );
+    scene.opaque = false;
+    scene.depth = 0.0f;
 
     [[maybe_unused]] constexpr float pi{ std::numbers::pi_v<float> };
     [[maybe_unused]] constexpr float tau{ pi + pi };
@@ -200,23 +204,17 @@ void App::render([[maybe_unused]] cge::Engine& engine, cge::Scene& scene)
         const float cx{ 0.0f };
         const float cy{ 0.0f };
 
+        // The triangle is built once around the origin, and rotated into place by the GPU.
+        scene.set_transform(cge::transform_2d({ cx, cy }, rot * tau, { rad, rad * aspect }));
         scene.draw_tri(
             std::array
             {
-                cge::Vertex {
-                    .xyzw = { cx + std::cos((rot - 0.0f / 3.0f) * tau) * rad, cy + std::sin((rot - 0.0f / 3.0f) * tau) * rad * aspect },
-                    .st = { invert ? 0xFF00FFFF : 0xFFFF0000 },
-                },
-                cge::Vertex {
-                    .xyzw = { cx + std::cos((rot - 1.0f / 3.0f) * tau) * rad, cy + std::sin((rot - 1.0f / 3.0f) * tau) * rad * aspect },
-                    .st = { invert ? 0xFFFF00FF : 0xFF00FF00 },
-                },
-                cge::Vertex {
-                    .xyzw = { cx + std::cos((rot - 2.0f / 3.0f) * tau) * rad, cy + std::sin((rot - 2.0f / 3.0f) * tau) * rad * aspect },
-                    .st = { invert ? 0xFFFFFF00 : 0xFF0000FF },
-                },
+                cge::Vertex { .xyzw = {  1.0f,  0.0f       }, .st = { invert ? 0xFF00FFFF : 0xFFFF0000 }, },
+                cge::Vertex { .xyzw = { -0.5f, -0.8660254f }, .st = { invert ? 0xFFFF00FF : 0xFF00FF00 }, },
+                cge::Vertex { .xyzw = { -0.5f,  0.8660254f }, .st = { invert ? 0xFFFFFF00 : 0xFF0000FF }, },
             }
         );
+        scene.reset_transform();
     }    
 
     scene.draw_strip(
@@ -255,23 +253,16 @@ void App::render([[maybe_unused]] cge::Engine& engine, cge::Scene& scene)
         const cge::Color c1{ mA };
         const cge::Color c2{ mA | mR | mG | mB };
 
+        scene.set_transform(cge::transform_2d({ cx, cy }, rot * tau, { rad, rad * aspect }));
         scene.draw_tri(
             std::array
             {
-                cge::Vertex {
-                    .xyzw = { cx + std::cos((rot - 0.0f / 3.0f) * tau) * rad, cy + std::sin((rot - 0.0f / 3.0f) * tau) * rad * aspect },
-                    .st = { c1 },
-                },
-                cge::Vertex {
-                    .xyzw = { cx + std::cos((rot - 1.0f / 3.0f) * tau) * rad, cy + std::sin((rot - 1.0f / 3.0f) * tau) * rad * aspect },
-                    .st = { c2 },
-                },
-                cge::Vertex {
-                    .xyzw = { cx + std::cos((rot - 2.0f / 3.0f) * tau) * rad, cy + std::sin((rot - 2.0f / 3.0f) * tau) * rad * aspect },
-                    .st = { c2 },
-                },
+                cge::Vertex { .xyzw = {  1.0f,  0.0f       }, .st = { c1 }, },
+                cge::Vertex { .xyzw = { -0.5f, -0.8660254f }, .st = { c2 }, },
+                cge::Vertex { .xyzw = { -0.5f,  0.8660254f }, .st = { c2 }, },
             }
         );
+        scene.reset_transform();
     }
 
     if (!this->window_focus)